@@ -19,6 +19,9 @@
  */
 
 #define _CRT_SECURE_NO_WARNINGS  // Windows平台禁用安全警告
+#define _POSIX_C_SOURCE 200809L  // 启用POSIX接口 (read, fileno, lseek)
+#define _DEFAULT_SOURCE          // glibc: syscall()
+#define _GNU_SOURCE              // glibc: fopencookie()
 #include <stdio.h>      // 标准输入输出
 #include <stdint.h>     // 固定宽度整型
 #include <inttypes.h>   // 打印格式宏
@@ -28,28 +31,267 @@
 #include <limits.h>     // 整型限制
 #include <string.h>     // 字符串函数
 #include <stdlib.h>     // 标准库函数
+#include <ctype.h>      // 字符分类函数
+#include <time.h>       // 计时函数
+#include <errno.h>      // 错误码
+
+#include <fcntl.h>      // open
+
+#ifdef _WIN32
+#include <io.h>         // _read, _write, _lseek
+#define open _open
+#define close _close
+#define read _read
+#define write _write
+#define lseek _lseek
+typedef int ssize_t;
+#else
+#include <unistd.h>     // read, write, lseek
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#define HAVE_PTHREAD 1
+#include <pthread.h>    // 线程
+#include <sys/uio.h>    // writev
+#include <sched.h>      // sched_yield
+#endif
+
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>   // 硬件性能计数器
+#endif
+
+// group varint的SIMD解码按函数启用SSSE3，运行时检测CPU后再调用
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_SSSE3_DISPATCH 1
+#include <tmmintrin.h>  // SSSE3指令集 (pshufb)
+#endif
 
 /*
  * ========================================
  * 调试和辅助宏定义
  * ========================================
  */
-#define DEBUG_PRINT(fmt, ...) \
-    printf("[DEBUG] %s:%d " fmt "\n", __FILE__, __LINE__, ##__VA_ARGS__)
+/*
+ * 调试追踪：编译时加 -DENABLE_TRACE 启用，否则TRACE/DEBUG_PRINT完全为空。
+ * 启用后不调用printf，只把二进制事件（时间戳、调用点、最多4个整数参数）
+ * 写入每个线程自己的环形缓冲区，程序退出时再解码成原来的文本（见第16节）。
+ * 参数支持整数、指针和浮点数（%s只能对应字符串常量）；浮点参数
+ * 按double的位模式保存，解码时按%f/%e/%g等原样格式化。
+ */
+#ifdef ENABLE_TRACE
+
+struct trace_site {             // 每个TRACE调用点一个静态实例，地址即调用点id
+    const char* file;
+    int line;
+    const char* fmt;
+    unsigned char arg_size[4];  // 各参数的sizeof，解码时用于截断和符号扩展
+    unsigned char arg_double;   // 第i位为1表示第i个参数是浮点数
+};
+
+void trace_record(const struct trace_site* site,
+                  uint64_t a0, uint64_t a1, uint64_t a2, uint64_t a3);
+
+static inline uint64_t trace_double_bits(double d) {
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(bits));
+    return bits;
+}
+
+// 浮点参数保存double的位模式，其他标量直接转换（_Generic只对选中的分支求值）
+#define TRACE_IS_DOUBLE(a) _Generic((a), float: 1, double: 1, long double: 1, default: 0)
+#define TRACE_AS_DOUBLE(a) _Generic((a), float: (a), double: (a), long double: (a), default: 0.0)
+#define TRACE_ARG(a) \
+    (TRACE_IS_DOUBLE(a) ? trace_double_bits((double)TRACE_AS_DOUBLE(a)) : (uint64_t)(a))
+
+#define TRACE_SITE(fmt, s0, s1, s2, s3, dbl) \
+    static const struct trace_site trace_site_ = \
+        {__FILE__, __LINE__, fmt, {s0, s1, s2, s3}, dbl}
+#define TRACE_0(fmt) do { \
+        TRACE_SITE(fmt, 0, 0, 0, 0, 0); \
+        trace_record(&trace_site_, 0, 0, 0, 0); \
+    } while (0)
+#define TRACE_1(fmt, a) do { \
+        TRACE_SITE(fmt, sizeof(a), 0, 0, 0, TRACE_IS_DOUBLE(a)); \
+        trace_record(&trace_site_, TRACE_ARG(a), 0, 0, 0); \
+    } while (0)
+#define TRACE_2(fmt, a, b) do { \
+        TRACE_SITE(fmt, sizeof(a), sizeof(b), 0, 0, \
+                   TRACE_IS_DOUBLE(a) | TRACE_IS_DOUBLE(b) << 1); \
+        trace_record(&trace_site_, TRACE_ARG(a), TRACE_ARG(b), 0, 0); \
+    } while (0)
+#define TRACE_3(fmt, a, b, c) do { \
+        TRACE_SITE(fmt, sizeof(a), sizeof(b), sizeof(c), 0, \
+                   TRACE_IS_DOUBLE(a) | TRACE_IS_DOUBLE(b) << 1 | TRACE_IS_DOUBLE(c) << 2); \
+        trace_record(&trace_site_, TRACE_ARG(a), TRACE_ARG(b), TRACE_ARG(c), 0); \
+    } while (0)
+#define TRACE_4(fmt, a, b, c, d) do { \
+        TRACE_SITE(fmt, sizeof(a), sizeof(b), sizeof(c), sizeof(d), \
+                   TRACE_IS_DOUBLE(a) | TRACE_IS_DOUBLE(b) << 1 | \
+                   TRACE_IS_DOUBLE(c) << 2 | TRACE_IS_DOUBLE(d) << 3); \
+        trace_record(&trace_site_, TRACE_ARG(a), TRACE_ARG(b), TRACE_ARG(c), TRACE_ARG(d)); \
+    } while (0)
+
+// 按参数个数选择TRACE_0 ~ TRACE_4
+#define TRACE_PICK(_0, _1, _2, _3, _4, name, ...) name
+#define TRACE(...) \
+    TRACE_PICK(__VA_ARGS__, TRACE_4, TRACE_3, TRACE_2, TRACE_1, TRACE_0, )(__VA_ARGS__)
+
+#else
+#define TRACE(...) ((void)0)
+#endif
+
+#define DEBUG_PRINT(fmt, ...) TRACE(fmt, ##__VA_ARGS__)
+
+/*
+ * 分段性能剖析：编译时加 -DENABLE_PROFILE 启用，运行时用 --profile 打开。
+ * 在函数开头写 PROFILE_FUNCTION(); 离开作用域时自动结束计时
+ * （依赖GCC/Clang的cleanup属性）。结果按调用树汇总调用次数和
+ * 包含/独占时间，并导出火焰图折叠栈和Chrome trace（见第17节）。
+ */
+#if defined(ENABLE_PROFILE) && defined(__GNUC__)
+
+struct profile_scope {
+    bool active;
+};
+
+static bool profile_enabled;            // 由 --profile 打开
+
+struct profile_scope profile_begin(const char* name);
+void profile_pop();
+
+static inline void profile_end(struct profile_scope* scope) {
+    if (scope->active) {
+        profile_pop();
+    }
+}
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(name) \
+    struct profile_scope PROFILE_CONCAT(profile_scope_, __LINE__) \
+        __attribute__((cleanup(profile_end))) = \
+        profile_enabled ? profile_begin(name) : (struct profile_scope){false}
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_FUNCTION() ((void)0)
+#endif
+
+/*
+ * 流式输入接口（实现见第12节）：第10节的交互式测试也使用它代替scanf
+ */
+#define STREAM_BUFFER_SIZE (64 * 1024)
+#define STREAM_MAX_TOKEN   128          // 单个记号的最大长度
+
+enum stream_status {
+    STREAM_OK = 0,
+    STREAM_EOF,             // 输入结束
+    STREAM_ERR_SYNTAX,      // 记号格式错误
+    STREAM_ERR_RANGE,       // 数值超出范围
+    STREAM_ERR_TOO_LONG,    // 记号超过STREAM_MAX_TOKEN
+    STREAM_ERR_IO           // read()失败
+};
+
+struct stream_reader {
+    int fd;
+    size_t pos;                 // 下一个未读字节在buf中的下标
+    size_t len;                 // buf中有效字节数
+    bool eof;
+    uint64_t buf_offset;        // buf[0]在整个输入中的偏移
+    uint64_t line;              // 当前行号（从1开始）
+    uint64_t line_start;        // 当前行首的偏移
+    enum stream_status status;
+    uint64_t err_line;          // 最近一次错误的位置
+    uint64_t err_column;
+    uint64_t err_offset;
+    char buf[STREAM_BUFFER_SIZE];
+};
+
+void stream_reader_init(struct stream_reader* r, int fd);
+const char* stream_status_string(enum stream_status status);
+void stream_skip_token(struct stream_reader* r);
+bool stream_read_int(struct stream_reader* r, long long* out);
+bool stream_read_double(struct stream_reader* r, double* out);
+bool stream_read_float(struct stream_reader* r, float* out);
+bool stream_read_char(struct stream_reader* r, char* out);
+void stream_print_error(const struct stream_reader* r, const char* name);
 
 #define SECTION_HEADER(title) \
     printf("\n" "="*60 "\n%s\n" "="*60 "\n", title)
 
-#define BINARY_PATTERN "%c%c%c%c%c%c%c%c"
-#define BINARY(byte) \
-    (byte & 0x80 ? '1' : '0'), \
-    (byte & 0x40 ? '1' : '0'), \
-    (byte & 0x20 ? '1' : '0'), \
-    (byte & 0x10 ? '1' : '0'), \
-    (byte & 0x08 ? '1' : '0'), \
-    (byte & 0x04 ? '1' : '0'), \
-    (byte & 0x02 ? '1' : '0'), \
-    (byte & 0x01 ? '1' : '0')
+/*
+ * ========================================
+ * 字节查找表（编译期生成）
+ * ========================================
+ *
+ * 十六进制、二进制渲染和字符分类的结果只取决于字节值，
+ * 因此预先算好256项的表，运行时只需一次查表。
+ * 三张表共约3KB，可以常驻L1缓存。
+ */
+
+// 十六进制对: hex_pair_table + 2*b 指向 "00".."ff"
+#define HEX16(hi) \
+    hi "0" hi "1" hi "2" hi "3" hi "4" hi "5" hi "6" hi "7" \
+    hi "8" hi "9" hi "a" hi "b" hi "c" hi "d" hi "e" hi "f"
+static const char hex_pair_table[] =
+    HEX16("0") HEX16("1") HEX16("2") HEX16("3")
+    HEX16("4") HEX16("5") HEX16("6") HEX16("7")
+    HEX16("8") HEX16("9") HEX16("a") HEX16("b")
+    HEX16("c") HEX16("d") HEX16("e") HEX16("f");
+
+// 8位二进制串: binary_table + 8*b 指向 "00000000".."11111111"
+#define BIN16(hi) \
+    hi "0000" hi "0001" hi "0010" hi "0011" hi "0100" hi "0101" hi "0110" hi "0111" \
+    hi "1000" hi "1001" hi "1010" hi "1011" hi "1100" hi "1101" hi "1110" hi "1111"
+static const char binary_table[] =
+    BIN16("0000") BIN16("0001") BIN16("0010") BIN16("0011")
+    BIN16("0100") BIN16("0101") BIN16("0110") BIN16("0111")
+    BIN16("1000") BIN16("1001") BIN16("1010") BIN16("1011")
+    BIN16("1100") BIN16("1101") BIN16("1110") BIN16("1111");
+
+// 字符分类位掩码（与"C" locale下的<ctype.h>结果一致，128~255均为0）
+#define CHAR_UPPER  0x01
+#define CHAR_LOWER  0x02
+#define CHAR_DIGIT  0x04
+#define CHAR_SPACE  0x08
+#define CHAR_PUNCT  0x10
+#define CHAR_CNTRL  0x20
+#define CHAR_PRINT  0x40    // 可打印ASCII (32~126)
+#define CHAR_XDIGIT 0x80
+#define CHAR_ALPHA  (CHAR_UPPER | CHAR_LOWER)
+#define CHAR_ALNUM  (CHAR_ALPHA | CHAR_DIGIT)
+
+#define CHAR_CLASS_OF(c) (unsigned char)( \
+    ((c) >= 'A' && (c) <= 'Z' ? CHAR_UPPER : 0) | \
+    ((c) >= 'a' && (c) <= 'z' ? CHAR_LOWER : 0) | \
+    ((c) >= '0' && (c) <= '9' ? CHAR_DIGIT : 0) | \
+    (((c) >= 9 && (c) <= 13) || (c) == ' ' ? CHAR_SPACE : 0) | \
+    ((c) > 32 && (c) < 127 && !((c) >= 'A' && (c) <= 'Z') && \
+     !((c) >= 'a' && (c) <= 'z') && !((c) >= '0' && (c) <= '9') ? CHAR_PUNCT : 0) | \
+    ((c) < 32 || (c) == 127 ? CHAR_CNTRL : 0) | \
+    ((c) >= 32 && (c) < 127 ? CHAR_PRINT : 0) | \
+    (((c) >= '0' && (c) <= '9') || ((c) >= 'a' && (c) <= 'f') || \
+     ((c) >= 'A' && (c) <= 'F') ? CHAR_XDIGIT : 0))
+#define CHAR_CLASS4(n)   CHAR_CLASS_OF(n), CHAR_CLASS_OF((n) + 1), \
+                         CHAR_CLASS_OF((n) + 2), CHAR_CLASS_OF((n) + 3)
+#define CHAR_CLASS16(n)  CHAR_CLASS4(n), CHAR_CLASS4((n) + 4), \
+                         CHAR_CLASS4((n) + 8), CHAR_CLASS4((n) + 12)
+#define CHAR_CLASS64(n)  CHAR_CLASS16(n), CHAR_CLASS16((n) + 16), \
+                         CHAR_CLASS16((n) + 32), CHAR_CLASS16((n) + 48)
+static const unsigned char char_class_table[256] = {
+    CHAR_CLASS64(0), CHAR_CLASS64(64), CHAR_CLASS64(128), CHAR_CLASS64(192)
+};
+
+#define HEX_PAIR(b)        (hex_pair_table + 2 * (unsigned char)(b))
+#define CHAR_IS(c, mask)   ((char_class_table[(unsigned char)(c)] & (mask)) != 0)
+#define CHAR_TO_UPPER(c)   (CHAR_IS(c, CHAR_LOWER) ? (char)((c) - 'a' + 'A') : (char)(c))
+#define CHAR_TO_LOWER(c)   (CHAR_IS(c, CHAR_UPPER) ? (char)((c) - 'A' + 'a') : (char)(c))
+
+#define BINARY_PATTERN "%.8s"
+#define BINARY(byte) (binary_table + 8 * (unsigned char)(byte))
 
 /*
  * ========================================
@@ -57,6 +299,7 @@
  * ========================================
  */
 void demonstrate_integer_types() {
+    PROFILE_FUNCTION();
     SECTION_HEADER("1. 整型数据类型详解");
     
     printf("=== 基本整型 ===\n");
@@ -150,6 +393,7 @@ void demonstrate_integer_types() {
  * ========================================
  */
 void demonstrate_floating_types() {
+    PROFILE_FUNCTION();
     SECTION_HEADER("2. 浮点型数据类型详解");
     
     printf("=== 基本浮点型 ===\n");
@@ -225,6 +469,7 @@ void demonstrate_floating_types() {
  * ========================================
  */
 void demonstrate_character_types() {
+    PROFILE_FUNCTION();
     SECTION_HEADER("3. 字符型数据类型详解");
     
     printf("=== 基本字符操作 ===\n");
@@ -259,19 +504,19 @@ void demonstrate_character_types() {
         char c = test_chars[i];
         printf("字符 '%c' (ASCII %d):\n", 
                (c == '\n') ? ' ' : c, c);
-        printf("  是字母: %s\n", isalpha(c) ? "是" : "否");
-        printf("  是数字: %s\n", isdigit(c) ? "是" : "否");
-        printf("  是字母数字: %s\n", isalnum(c) ? "是" : "否");
-        printf("  是空白字符: %s\n", isspace(c) ? "是" : "否");
-        printf("  是大写: %s\n", isupper(c) ? "是" : "否");
-        printf("  是小写: %s\n", islower(c) ? "是" : "否");
+        printf("  是字母: %s\n", CHAR_IS(c, CHAR_ALPHA) ? "是" : "否");
+        printf("  是数字: %s\n", CHAR_IS(c, CHAR_DIGIT) ? "是" : "否");
+        printf("  是字母数字: %s\n", CHAR_IS(c, CHAR_ALNUM) ? "是" : "否");
+        printf("  是空白字符: %s\n", CHAR_IS(c, CHAR_SPACE) ? "是" : "否");
+        printf("  是大写: %s\n", CHAR_IS(c, CHAR_UPPER) ? "是" : "否");
+        printf("  是小写: %s\n", CHAR_IS(c, CHAR_LOWER) ? "是" : "否");
         printf("\n");
     }
     
     printf("=== 字符转换 ===\n");
     char lower = 'a', upper = 'A';
-    printf("小写转大写: %c -> %c\n", lower, toupper(lower));
-    printf("大写转小写: %c -> %c\n", upper, tolower(upper));
+    printf("小写转大写: %c -> %c\n", lower, CHAR_TO_UPPER(lower));
+    printf("大写转小写: %c -> %c\n", upper, CHAR_TO_LOWER(upper));
 }
 
 /*
@@ -280,6 +525,7 @@ void demonstrate_character_types() {
  * ========================================
  */
 void demonstrate_boolean_types() {
+    PROFILE_FUNCTION();
     SECTION_HEADER("4. 布尔类型详解");
     
     printf("=== 基本布尔操作 ===\n");
@@ -341,6 +587,7 @@ void demonstrate_boolean_types() {
  * ========================================
  */
 void demonstrate_type_conversions() {
+    PROFILE_FUNCTION();
     SECTION_HEADER("5. 类型转换详解");
     
     printf("=== 隐式类型转换 ===\n");
@@ -406,6 +653,7 @@ void demonstrate_type_conversions() {
  * ========================================
  */
 void demonstrate_io_formatting() {
+    PROFILE_FUNCTION();
     SECTION_HEADER("6. 输入输出格式化详解");
     
     printf("=== printf格式化说明符 ===\n");
@@ -470,6 +718,7 @@ void demonstrate_io_formatting() {
  * ========================================
  */
 void demonstrate_memory_model() {
+    PROFILE_FUNCTION();
     SECTION_HEADER("7. 内存模型和存储类详解");
     
     printf("=== 存储类说明符 ===\n");
@@ -544,6 +793,7 @@ void demonstrate_memory_model() {
  * ========================================
  */
 void demonstrate_advanced_topics() {
+    PROFILE_FUNCTION();
     SECTION_HEADER("8. 高级主题：位操作和内存布局");
     
     printf("=== 位操作详解 ===\n");
@@ -634,37 +884,47 @@ void demonstrate_advanced_topics() {
  */
 
 // 打印内存内容的十六进制转储
+// 每行先在缓冲区中用查找表拼好，再一次性输出
 void hex_dump(void* ptr, size_t size) {
+    PROFILE_FUNCTION();
     unsigned char* bytes = (unsigned char*)ptr;
+    char line[80];
+    DEBUG_PRINT("hex_dump(ptr=%p, size=%zu)", ptr, size);
     printf("内存转储 (地址: %p, 大小: %zu字节):\n", ptr, size);
     
     for (size_t i = 0; i < size; i += 16) {
-        printf("%08zx: ", i);
+        char* p = line + sprintf(line, "%08zx: ", i);
+        size_t n = (size - i < 16) ? size - i : 16;
         
         // 十六进制部分
-        for (size_t j = 0; j < 16 && i + j < size; j++) {
-            printf("%02x ", bytes[i + j]);
+        for (size_t j = 0; j < n; j++) {
+            memcpy(p, HEX_PAIR(bytes[i + j]), 2);
+            p[2] = ' ';
+            p += 3;
         }
         
         // 填充空格
-        for (size_t j = size - i; j < 16 && j > 0; j++) {
-            printf("   ");
-        }
+        memset(p, ' ', 3 * (16 - n));
+        p += 3 * (16 - n);
         
-        printf(" |");
+        *p++ = ' ';
+        *p++ = '|';
         
         // ASCII部分
-        for (size_t j = 0; j < 16 && i + j < size; j++) {
-            char c = bytes[i + j];
-            printf("%c", (c >= 32 && c < 127) ? c : '.');
+        for (size_t j = 0; j < n; j++) {
+            unsigned char c = bytes[i + j];
+            *p++ = CHAR_IS(c, CHAR_PRINT) ? (char)c : '.';
         }
         
-        printf("|\n");
+        *p++ = '|';
+        *p++ = '\n';
+        fwrite(line, 1, (size_t)(p - line), stdout);
     }
 }
 
 // 类型信息打印
 void print_type_info() {
+    PROFILE_FUNCTION();
     printf("\n=== 编译器类型信息 ===\n");
     printf("编译器: ");
     #ifdef __GNUC__
@@ -705,20 +965,40 @@ void print_type_info() {
     printf("size_t大小: %zu字节\n", sizeof(size_t));
 }
 
+// 单调时钟，单位纳秒（用于测量墙上时间）
+static uint64_t monotonic_ns() {
+    struct timespec ts;
+#ifdef _WIN32
+    timespec_get(&ts, TIME_UTC);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
 /*
  * ========================================
  * 10. 测试和演示函数
  * ========================================
  */
 void run_interactive_tests() {
+    PROFILE_FUNCTION();
     printf("\n=== 交互式测试 ===\n");
     printf("以下是一些可以手动测试的功能:\n\n");
     
+    printf("输入使用第12节的stream_reader，直接从标准输入(fd 0)读取:\n");
+    printf("（批量验证请使用 --batch int|char|float [文件]，见第14节）\n\n");
+    
     printf("1. 输入验证测试:\n");
     /*
-    int number;
+    static struct stream_reader in;    // 64KB缓冲区，不要放在栈上
+    stream_reader_init(&in, 0);
+    
+    long long value;
     printf("请输入一个整数: ");
-    if (scanf("%d", &number) == 1) {
+    fflush(stdout);                     // stream_reader绕过stdio，先刷新提示
+    if (stream_read_int(&in, &value) && value >= INT_MIN && value <= INT_MAX) {
+        int number = (int)value;
         printf("您输入的数字是: %d\n", number);
         printf("十六进制: 0x%x\n", number);
         printf("二进制: ");
@@ -728,7 +1008,8 @@ void run_interactive_tests() {
         }
         printf("\n");
     } else {
-        printf("输入无效!\n");
+        stream_print_error(&in, "<stdin>");   // 例如 <stdin>:1:3: 格式错误
+        stream_skip_token(&in);
     }
     */
     
@@ -736,16 +1017,20 @@ void run_interactive_tests() {
     /*
     char ch;
     printf("请输入一个字符: ");
-    scanf(" %c", &ch);  // 注意空格用于跳过空白字符
+    fflush(stdout);
+    if (!stream_read_char(&in, &ch)) {  // 自动跳过空白字符，等价于scanf(" %c")
+        stream_print_error(&in, "<stdin>");
+        return;
+    }
     printf("字符: %c, ASCII: %d\n", ch, ch);
-    if (isalpha(ch)) {
+    if (CHAR_IS(ch, CHAR_ALPHA)) {      // 与--batch char共用查找表
         printf("这是一个字母\n");
-        if (islower(ch)) {
-            printf("小写字母，大写为: %c\n", toupper(ch));
+        if (CHAR_IS(ch, CHAR_LOWER)) {
+            printf("小写字母，大写为: %c\n", CHAR_TO_UPPER(ch));
         } else {
-            printf("大写字母，小写为: %c\n", tolower(ch));
+            printf("大写字母，小写为: %c\n", CHAR_TO_LOWER(ch));
         }
-    } else if (isdigit(ch)) {
+    } else if (CHAR_IS(ch, CHAR_DIGIT)) {
         printf("这是一个数字\n");
     } else {
         printf("这是特殊字符\n");
@@ -753,11 +1038,16 @@ void run_interactive_tests() {
     */
     
     printf("3. 浮点精度测试:\n");
+    printf("（对全部float位模式的穷举检查请使用 --float-sweep，见第18节）\n");
     /*
     float f_val;
     double d_val;
     printf("请输入一个小数: ");
-    scanf("%f", &f_val);
+    fflush(stdout);
+    if (!stream_read_float(&in, &f_val)) {
+        stream_print_error(&in, "<stdin>");
+        return;
+    }
     d_val = f_val;
     printf("float值: %.20f\n", f_val);
     printf("转为double: %.20lf\n", d_val);
@@ -767,6 +1057,7 @@ void run_interactive_tests() {
 
 // 性能测试函数
 void performance_tests() {
+    PROFILE_FUNCTION();
     SECTION_HEADER("性能测试");
     
     const int iterations = 1000000;
@@ -805,31 +1096,3171 @@ void performance_tests() {
 
 /*
  * ========================================
- * 主函数 - 程序入口点
+ * 11. 整数压缩编码 (varint / zigzag / delta / group varint)
  * ========================================
+ *
+ * int64_t固定占8字节，但实际数据中的大多数数值只有很少的有效字节。
+ * 变长编码只保存有效位，数值越小占用的字节越少：
+ *   - LEB128 varint: 每字节7位数据 + 1位"后面还有"标志
+ *   - zigzag: 把有符号数交错映射为无符号数 (0,-1,1,-2 -> 0,1,2,3)
+ *   - delta + zigzag: 有序序列只保存相邻差值
+ *   - group varint: 4个uint32共用一个控制字节，可用SIMD整组解码
  */
-int main() {
-    printf("C语言完整教程 - 基础数据类型详解\n");
-    printf("版本: v2.0.0\n");
-    printf("编译时间: %s %s\n", __DATE__, __TIME__);
+
+#define VARINT_MAX_BYTES 10             // uint64_t最多需要10字节
+#define GROUP_VARINT_MAX_BYTES(n) ((((n) + 3) / 4) * 17)
+
+// xorshift64伪随机数生成器（用于生成测试数据）
+static uint64_t xorshift64(uint64_t* state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+// zigzag编码：符号位移到最低位，绝对值小的负数也能编码得很短
+static inline uint64_t zigzag_encode64(int64_t v) {
+    return ((uint64_t)v << 1) ^ (0 - ((uint64_t)v >> 63));
+}
+
+static inline int64_t zigzag_decode64(uint64_t u) {
+    return (int64_t)((u >> 1) ^ (0 - (u & 1)));
+}
+
+// 编码单个值，返回写入的字节数 (1~10)
+static inline size_t varint_put_u64(uint8_t* out, uint64_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        out[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    out[n++] = (uint8_t)v;
+    return n;
+}
+
+// 解码单个值，返回消耗的字节数；输入截断、超过10字节或溢出64位时返回0
+static inline size_t varint_get_u64(const uint8_t* in, const uint8_t* end,
+                                    uint64_t* value) {
+    uint64_t result = 0;
+    const uint8_t* p = in;
     
-    // 打印系统信息
-    print_type_info();
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        uint8_t b = *p++;
+        if (shift == 63 && b > 1) {     // 第10字节只剩最高1位可用
+            return 0;
+        }
+        result |= (uint64_t)(b & 0x7F) << shift;
+        if (b < 0x80) {
+            *value = result;
+            return (size_t)(p - in);
+        }
+    }
+    return 0;
+}
+
+/*
+ * 批量接口约定：
+ *   encode: out至少有 count * VARINT_MAX_BYTES 字节，返回写入的字节数
+ *   decode: 最多解出count个值，返回实际解出的个数（小于count表示数据损坏）
+ */
+size_t varint_encode_u64(const uint64_t* in, size_t count, uint8_t* out) {
+    uint8_t* p = out;
+    for (size_t i = 0; i < count; i++) {
+        p += varint_put_u64(p, in[i]);
+    }
+    return (size_t)(p - out);
+}
+
+size_t varint_decode_u64(const uint8_t* in, size_t len,
+                         uint64_t* out, size_t count) {
+    const uint8_t* p = in;
+    const uint8_t* end = in + len;
+    size_t i;
     
-    // 演示各个主题
-    demonstrate_integer_types();
-    demonstrate_floating_types();
-    demonstrate_character_types();
-    demonstrate_boolean_types();
-    demonstrate_type_conversions();
-    demonstrate_io_formatting();
-    demonstrate_memory_model();
-    demonstrate_advanced_topics();
+    for (i = 0; i < count && p < end; i++) {
+        if (*p < 0x80) {            // 单字节快速路径
+            out[i] = *p++;
+            continue;
+        }
+        size_t n = varint_get_u64(p, end, &out[i]);
+        if (n == 0) {
+            break;
+        }
+        p += n;
+    }
+    return i;
+}
+
+size_t zigzag_encode_i64(const int64_t* in, size_t count, uint8_t* out) {
+    uint8_t* p = out;
+    for (size_t i = 0; i < count; i++) {
+        p += varint_put_u64(p, zigzag_encode64(in[i]));
+    }
+    return (size_t)(p - out);
+}
+
+size_t zigzag_decode_i64(const uint8_t* in, size_t len,
+                         int64_t* out, size_t count) {
+    const uint8_t* p = in;
+    const uint8_t* end = in + len;
+    size_t i;
     
-    // 内存转储示例
-    SECTION_HEADER("内存转储示例");
-    int sample_data[] = {0x12345678, 0xABCDEF00, 0x11223344};
-    hex_dump(sample_data, sizeof(sample_data));
+    for (i = 0; i < count && p < end; i++) {
+        uint64_t u;
+        size_t n = varint_get_u64(p, end, &u);
+        if (n == 0) {
+            break;
+        }
+        out[i] = zigzag_decode64(u);
+        p += n;
+    }
+    return i;
+}
+
+// delta编码：保存与前一个值的差（第一个值与0相比），再做zigzag+varint
+// 有序序列的差值很小，通常1~2字节即可
+size_t delta_encode_i64(const int64_t* in, size_t count, uint8_t* out) {
+    uint8_t* p = out;
+    uint64_t prev = 0;
+    for (size_t i = 0; i < count; i++) {
+        // 用无符号减法避免有符号溢出
+        uint64_t diff = (uint64_t)in[i] - prev;
+        p += varint_put_u64(p, zigzag_encode64((int64_t)diff));
+        prev = (uint64_t)in[i];
+    }
+    return (size_t)(p - out);
+}
+
+size_t delta_decode_i64(const uint8_t* in, size_t len,
+                        int64_t* out, size_t count) {
+    const uint8_t* p = in;
+    const uint8_t* end = in + len;
+    uint64_t prev = 0;
+    size_t i;
+    
+    for (i = 0; i < count && p < end; i++) {
+        uint64_t u;
+        size_t n = varint_get_u64(p, end, &u);
+        if (n == 0) {
+            break;
+        }
+        prev += (uint64_t)zigzag_decode64(u);
+        out[i] = (int64_t)prev;
+        p += n;
+    }
+    return i;
+}
+
+/*
+ * group varint: 每组4个uint32，格式为 [控制字节][数据4~16字节]
+ * 控制字节每2位表示一个值的字节数减1（低位对应第一个值）。
+ * 解码时可用查表得到的pshufb掩码一次展开整组。
+ * 最后不足4个的组用0补齐。
+ */
+static uint8_t group_varint_length[256];        // 控制字节 -> 数据字节数
+static uint8_t group_varint_shuffle[256][16];   // 控制字节 -> pshufb掩码
+static bool group_varint_ready = false;
+static bool group_varint_simd = false;          // CPU支持SSSE3时为true
+
+static void group_varint_init_tables() {
+    for (int ctrl = 0; ctrl < 256; ctrl++) {
+        int offset = 0;
+        for (int k = 0; k < 4; k++) {
+            int len = ((ctrl >> (2 * k)) & 3) + 1;
+            for (int j = 0; j < 4; j++) {
+                // 0x80使pshufb输出0
+                group_varint_shuffle[ctrl][4 * k + j] =
+                    (j < len) ? (uint8_t)(offset + j) : 0x80;
+            }
+            offset += len;
+        }
+        group_varint_length[ctrl] = (uint8_t)offset;
+    }
+#ifdef HAVE_SSSE3_DISPATCH
+    __builtin_cpu_init();
+    group_varint_simd = __builtin_cpu_supports("ssse3");
+#endif
+    group_varint_ready = true;
+}
+
+static inline int u32_byte_length(uint32_t v) {
+    return (v < (1U << 8)) ? 1 : (v < (1U << 16)) ? 2 : (v < (1U << 24)) ? 3 : 4;
+}
+
+// out至少有 GROUP_VARINT_MAX_BYTES(count) 字节
+size_t group_varint_encode_u32(const uint32_t* in, size_t count, uint8_t* out) {
+    uint8_t* p = out;
+    
+    for (size_t i = 0; i < count; i += 4) {
+        uint8_t* ctrl = p++;
+        *ctrl = 0;
+        for (int k = 0; k < 4; k++) {
+            uint32_t v = (i + k < count) ? in[i + k] : 0;
+            int len = u32_byte_length(v);
+            *ctrl |= (uint8_t)((len - 1) << (2 * k));
+            for (int j = 0; j < len; j++) {     // 小端写入
+                *p++ = (uint8_t)(v >> (8 * j));
+            }
+        }
+    }
+    return (size_t)(p - out);
+}
+
+// 标量路径：从out[i]开始逐组解码，返回解出的总个数
+static size_t group_varint_decode_groups(const uint8_t* p, const uint8_t* end,
+                                         uint32_t* out, size_t i, size_t count) {
+    while (i < count && p < end) {
+        uint8_t ctrl = *p++;
+        if (end - p < group_varint_length[ctrl]) {
+            break;
+        }
+        for (int k = 0; k < 4; k++) {
+            int n = ((ctrl >> (2 * k)) & 3) + 1;
+            uint32_t v = 0;
+            for (int j = 0; j < n; j++) {
+                v |= (uint32_t)p[j] << (8 * j);
+            }
+            p += n;
+            if (i < count) {
+                out[i++] = v;
+            }
+        }
+    }
+    return i;
+}
+
+#ifdef HAVE_SSSE3_DISPATCH
+// SIMD路径：每次读取16字节，所以要求控制字节后还有至少16字节，剩余的组交给标量路径
+__attribute__((target("ssse3")))
+static size_t group_varint_decode_ssse3(const uint8_t* in, size_t len,
+                                        uint32_t* out, size_t count) {
+    const uint8_t* p = in;
+    const uint8_t* end = in + len;
+    size_t i = 0;
+    
+    while (i + 4 <= count && end - p >= 17) {
+        uint8_t ctrl = *p++;
+        __m128i data = _mm_loadu_si128((const __m128i*)p);
+        __m128i mask = _mm_loadu_si128((const __m128i*)group_varint_shuffle[ctrl]);
+        _mm_storeu_si128((__m128i*)(out + i), _mm_shuffle_epi8(data, mask));
+        p += group_varint_length[ctrl];
+        i += 4;
+    }
+    return group_varint_decode_groups(p, end, out, i, count);
+}
+#endif
+
+// 只用标量路径解码（用于和SIMD路径对比）
+size_t group_varint_decode_u32_scalar(const uint8_t* in, size_t len,
+                                      uint32_t* out, size_t count) {
+    if (!group_varint_ready) {
+        group_varint_init_tables();
+    }
+    return group_varint_decode_groups(in, in + len, out, 0, count);
+}
+
+// CPU支持SSSE3时自动使用pshufb解码
+size_t group_varint_decode_u32(const uint8_t* in, size_t len,
+                               uint32_t* out, size_t count) {
+    if (!group_varint_ready) {
+        group_varint_init_tables();
+    }
+#ifdef HAVE_SSSE3_DISPATCH
+    if (group_varint_simd) {
+        return group_varint_decode_ssse3(in, len, out, count);
+    }
+#endif
+    return group_varint_decode_groups(in, in + len, out, 0, count);
+}
+
+// 演示各种编码的字节布局
+void demonstrate_integer_compression() {
+    PROFILE_FUNCTION();
+    SECTION_HEADER("11. 整数压缩编码");
+    
+    uint8_t buf[VARINT_MAX_BYTES];
+    
+    printf("=== LEB128 varint ===\n");
+    uint64_t samples[] = {1, 127, 128, 300, 16384, 1ULL << 40, UINT64_MAX};
+    for (size_t i = 0; i < sizeof(samples) / sizeof(samples[0]); i++) {
+        size_t n = varint_put_u64(buf, samples[i]);
+        printf("%20" PRIu64 " -> %2zu字节:", samples[i], n);
+        for (size_t j = 0; j < n; j++) {
+            printf(" %02x", buf[j]);
+        }
+        printf("\n");
+    }
+    
+    printf("\n=== zigzag映射 ===\n");
+    int64_t signed_samples[] = {0, -1, 1, -2, 2, -64, 64, INT64_MIN};
+    for (size_t i = 0; i < sizeof(signed_samples) / sizeof(signed_samples[0]); i++) {
+        uint64_t z = zigzag_encode64(signed_samples[i]);
+        printf("%20" PRId64 " -> %20" PRIu64 " (varint %zu字节)\n",
+               signed_samples[i], z, varint_put_u64(buf, z));
+    }
+    
+    printf("\n=== delta编码（有序序列） ===\n");
+    int64_t sorted[] = {1000000, 1000003, 1000010, 1000011, 1000042};
+    uint8_t delta_buf[5 * VARINT_MAX_BYTES];
+    size_t delta_len = delta_encode_i64(sorted, 5, delta_buf);
+    printf("5个int64: 原始%zu字节 -> delta编码%zu字节:", sizeof(sorted), delta_len);
+    for (size_t j = 0; j < delta_len; j++) {
+        printf(" %02x", delta_buf[j]);
+    }
+    printf("\n");
+    
+    printf("\n=== group varint ===\n");
+    uint32_t group[] = {1, 300, 70000, 0x12345678};
+    uint8_t group_buf[GROUP_VARINT_MAX_BYTES(4)];
+    size_t group_len = group_varint_encode_u32(group, 4, group_buf);
+    printf("{1, 300, 70000, 0x12345678} -> %zu字节, 控制字节: " BINARY_PATTERN "\n",
+           group_len, BINARY(group_buf[0]));
+}
+
+// 基准测试用的统一解码函数签名
+typedef size_t (*decode_fn)(const uint8_t* in, size_t len, void* out, size_t count);
+
+static size_t bench_varint(const uint8_t* in, size_t len, void* out, size_t count) {
+    return varint_decode_u64(in, len, (uint64_t*)out, count);
+}
+
+static size_t bench_zigzag(const uint8_t* in, size_t len, void* out, size_t count) {
+    return zigzag_decode_i64(in, len, (int64_t*)out, count);
+}
+
+static size_t bench_delta(const uint8_t* in, size_t len, void* out, size_t count) {
+    return delta_decode_i64(in, len, (int64_t*)out, count);
+}
+
+static size_t bench_group(const uint8_t* in, size_t len, void* out, size_t count) {
+    return group_varint_decode_u32(in, len, (uint32_t*)out, count);
+}
+
+static size_t bench_group_scalar(const uint8_t* in, size_t len, void* out, size_t count) {
+    return group_varint_decode_u32_scalar(in, len, (uint32_t*)out, count);
+}
+
+// 重复解码并校验，压缩率和GB/s按原始元素大小(elem_size)计算
+static void report_codec(const char* name, const char* dataset, decode_fn decode,
+                         const uint8_t* encoded, size_t encoded_len,
+                         const void* expected, size_t elem_size,
+                         void* out, size_t count) {
+    const int repeats = 20;
+    size_t decoded = 0;
+    
+    clock_t start = clock();
+    for (int r = 0; r < repeats; r++) {
+        decoded = decode(encoded, encoded_len, out, count);
+    }
+    clock_t end = clock();
+    
+    double seconds = ((double)(end - start)) / CLOCKS_PER_SEC;
+    double ratio = (double)(count * elem_size) / (double)encoded_len;
+    double gbps = seconds > 0
+        ? (double)count * elem_size * repeats / seconds / 1e9 : 0.0;
+    bool ok = decoded == count && memcmp(out, expected, count * elem_size) == 0;
+    
+    printf("%-18s %-10s %8.2fx %10.2f %8.2f  %s\n", name, dataset, ratio,
+           (double)encoded_len / count, gbps, ok ? "OK" : "校验失败");
+}
+
+// 压缩率和解码速度测试
+void integer_codec_benchmark() {
+    PROFILE_FUNCTION();
+    SECTION_HEADER("整数压缩编码性能测试");
+    
+    if (!group_varint_ready) {
+        group_varint_init_tables();     // 下面要先知道是否有SIMD路径
+    }
+    
+    const size_t count = 1 << 20;
+    uint64_t* random_u64 = malloc(count * sizeof(uint64_t));
+    int64_t* random_i64 = malloc(count * sizeof(int64_t));
+    uint32_t* random_u32 = malloc(count * sizeof(uint32_t));
+    int64_t* sorted_i64 = malloc(count * sizeof(int64_t));
+    uint8_t* encoded = malloc(count * VARINT_MAX_BYTES);
+    uint64_t* decoded = malloc(count * sizeof(uint64_t));
+    
+    if (!random_u64 || !random_i64 || !random_u32 || !sorted_i64 ||
+        !encoded || !decoded) {
+        printf("内存分配失败\n");
+        goto cleanup;
+    }
+    
+    // 合成数据：有效位数在1~32之间均匀分布；有序数据：随机间隔0~255
+    uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    int64_t current = 1700000000000LL;
+    for (size_t i = 0; i < count; i++) {
+        uint64_t r = xorshift64(&seed);
+        int bits = (int)(r % 32) + 1;
+        uint64_t v = (r >> 8) & ((1ULL << bits) - 1);
+        random_u64[i] = v;
+        random_u32[i] = (uint32_t)v;
+        random_i64[i] = (r & 0x80) ? -(int64_t)v : (int64_t)v;
+        current += (int64_t)(r >> 56);
+        sorted_i64[i] = current;
+    }
+    
+    printf("数据量: %zu个值，压缩率和速度按原始类型计算"
+           "（group varint为uint32，其余为64位）\n\n", count);
+    printf("%-18s %-10s %9s %10s %8s\n", "编码", "数据集", "压缩率", "字节/值", "GB/s");
+    
+    size_t len = varint_encode_u64(random_u64, count, encoded);
+    report_codec("varint", "random", bench_varint, encoded, len,
+                 random_u64, sizeof(uint64_t), decoded, count);
+    
+    len = zigzag_encode_i64(random_i64, count, encoded);
+    report_codec("zigzag+varint", "random", bench_zigzag, encoded, len,
+                 random_i64, sizeof(int64_t), decoded, count);
+    
+    len = group_varint_encode_u32(random_u32, count, encoded);
+    report_codec("group varint", "random", bench_group_scalar, encoded, len,
+                 random_u32, sizeof(uint32_t), decoded, count);
+    if (group_varint_simd) {
+        report_codec("group varint+SIMD", "random", bench_group, encoded, len,
+                     random_u32, sizeof(uint32_t), decoded, count);
+    }
+    
+    len = zigzag_encode_i64(sorted_i64, count, encoded);
+    report_codec("zigzag+varint", "sorted", bench_zigzag, encoded, len,
+                 sorted_i64, sizeof(int64_t), decoded, count);
+    
+    len = delta_encode_i64(sorted_i64, count, encoded);
+    report_codec("delta+zigzag", "sorted", bench_delta, encoded, len,
+                 sorted_i64, sizeof(int64_t), decoded, count);
+    
+    printf("\ngroup varint+SIMD: %s\n", group_varint_simd
+           ? "SSSE3 pshufb整组解码（运行时检测到CPU支持）"
+           : "CPU或编译器不支持SSSE3，只测试标量解码");
+    
+cleanup:
+    free(random_u64);
+    free(random_i64);
+    free(random_u32);
+    free(sorted_i64);
+    free(encoded);
+    free(decoded);
+}
+
+/*
+ * ========================================
+ * 12. 流式输入解析器（替代scanf）
+ * ========================================
+ *
+ * scanf每次调用都要解析格式串、加锁、逐字符读取，出错后也很难
+ * 知道错误在输入中的位置。这里用固定大小的缓冲区配合read(2)
+ * 成块读取，在缓冲区内直接切分和解析记号：
+ *   - 内存占用固定，不做任何动态分配
+ *   - 只有缓冲区读完时才产生系统调用
+ *   - 出错时报告准确的行号、列号和字节偏移
+ * struct stream_reader和公开函数的声明在文件开头。
+ */
+
+void stream_reader_init(struct stream_reader* r, int fd) {
+    r->fd = fd;
+    r->pos = 0;
+    r->len = 0;
+    r->eof = false;
+    r->buf_offset = 0;
+    r->line = 1;
+    r->line_start = 0;
+    r->status = STREAM_OK;
+    r->err_line = 0;
+    r->err_column = 0;
+    r->err_offset = 0;
+}
+
+const char* stream_status_string(enum stream_status status) {
+    switch (status) {
+        case STREAM_OK:           return "成功";
+        case STREAM_EOF:          return "输入结束";
+        case STREAM_ERR_SYNTAX:   return "格式错误";
+        case STREAM_ERR_RANGE:    return "数值超出范围";
+        case STREAM_ERR_TOO_LONG: return "记号过长";
+        case STREAM_ERR_IO:       return "读取失败";
+    }
+    return "未知错误";
+}
+
+// 把未读部分移到缓冲区开头，再用read()填满剩余空间
+static void stream_fill(struct stream_reader* r) {
+    size_t remaining = r->len - r->pos;
+    
+    if (r->pos > 0) {
+        memmove(r->buf, r->buf + r->pos, remaining);
+        r->buf_offset += r->pos;
+        r->pos = 0;
+        r->len = remaining;
+    }
+    
+    while (!r->eof && r->len < STREAM_BUFFER_SIZE) {
+        ssize_t n = read(r->fd, r->buf + r->len, STREAM_BUFFER_SIZE - r->len);
+        if (n > 0) {
+            r->len += (size_t)n;
+            return;                 // 读到数据即可，不等待填满
+        }
+        if (n == 0) {
+            r->eof = true;
+        } else if (errno != EINTR) {
+            r->eof = true;
+            r->status = STREAM_ERR_IO;
+        }
+    }
+}
+
+static bool stream_fail(struct stream_reader* r, enum stream_status status,
+                        size_t at) {
+    uint64_t offset = r->buf_offset + at;
+    r->status = status;
+    r->err_line = r->line;
+    r->err_column = offset - r->line_start + 1;
+    r->err_offset = offset;
+    return false;
+}
+
+static inline bool stream_is_delim(char c) {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' ||
+           c == '\v' || c == '\f';
+}
+
+// 缓冲区中的记号是否完整：后面已有分隔符、已到输入结尾或已超过最大长度
+static bool stream_token_complete(const struct stream_reader* r) {
+    size_t limit = r->pos + STREAM_MAX_TOKEN + 1;
+    
+    if (r->eof || r->len >= limit) {
+        return true;
+    }
+    for (size_t i = r->pos; i < r->len; i++) {
+        if (stream_is_delim(r->buf[i])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 跳过空白并保证缓冲区内至少有一个完整记号，返回记号起点
+// 只有记号还没结束时才继续read()，交互输入时回车后立即返回
+static bool stream_next_token(struct stream_reader* r) {
+    for (;;) {
+        while (r->pos < r->len) {
+            char c = r->buf[r->pos];
+            if (c == '\n') {
+                r->line++;
+                r->line_start = r->buf_offset + r->pos + 1;
+            } else if (c != ' ' && c != '\t' && c != '\r' &&
+                       c != '\v' && c != '\f') {
+                break;
+            }
+            r->pos++;
+        }
+        
+        if ((r->pos == r->len && !r->eof) ||
+            (r->pos < r->len && !stream_token_complete(r))) {
+            stream_fill(r);
+            if (r->status == STREAM_ERR_IO) {
+                return stream_fail(r, STREAM_ERR_IO, r->pos);
+            }
+            continue;
+        }
+        if (r->pos == r->len) {
+            r->status = STREAM_EOF;
+            return false;
+        }
+        return true;
+    }
+}
+
+// 返回当前记号的长度，超过STREAM_MAX_TOKEN时返回0
+static size_t stream_token_length(const struct stream_reader* r) {
+    size_t end = r->pos;
+    size_t limit = r->pos + STREAM_MAX_TOKEN;
+    
+    if (limit > r->len) {
+        limit = r->len;
+    }
+    while (end < limit && !stream_is_delim(r->buf[end])) {
+        end++;
+    }
+    if (end == limit && limit < r->len && !stream_is_delim(r->buf[limit])) {
+        return 0;
+    }
+    return end - r->pos;
+}
+
+// 跳过当前记号（出错后用于恢复）
+void stream_skip_token(struct stream_reader* r) {
+    if (!stream_next_token(r)) {
+        return;
+    }
+    while (r->pos < r->len && !stream_is_delim(r->buf[r->pos])) {
+        r->pos++;
+        if (r->pos == r->len && !r->eof) {
+            stream_fill(r);
+        }
+    }
+    r->status = STREAM_OK;
+}
+
+// 读取一个十进制整数，等价于 scanf("%lld")，但要求整个记号都是数字
+bool stream_read_int(struct stream_reader* r, long long* out) {
+    if (!stream_next_token(r)) {
+        return false;
+    }
+    
+    size_t n = stream_token_length(r);
+    if (n == 0) {
+        return stream_fail(r, STREAM_ERR_TOO_LONG, r->pos);
+    }
+    
+    size_t p = r->pos;
+    size_t end = r->pos + n;
+    bool negative = false;
+    
+    if (r->buf[p] == '-' || r->buf[p] == '+') {
+        negative = (r->buf[p] == '-');
+        p++;
+    }
+    if (p == end || r->buf[p] < '0' || r->buf[p] > '9') {
+        return stream_fail(r, STREAM_ERR_SYNTAX, p);
+    }
+    
+    // 用无符号累加，LLONG_MIN的绝对值比LLONG_MAX大1
+    unsigned long long limit = negative
+        ? (unsigned long long)LLONG_MAX + 1 : (unsigned long long)LLONG_MAX;
+    unsigned long long value = 0;
+    size_t digits_start = p;
+    
+    while (p < end && r->buf[p] >= '0' && r->buf[p] <= '9') {
+        unsigned digit = (unsigned)(r->buf[p] - '0');
+        if (value > (limit - digit) / 10) {
+            return stream_fail(r, STREAM_ERR_RANGE, digits_start);
+        }
+        value = value * 10 + digit;
+        p++;
+    }
+    if (p < end) {
+        return stream_fail(r, STREAM_ERR_SYNTAX, p);
+    }
+    
+    *out = negative ? (long long)(0 - value) : (long long)value;
+    r->pos = p;
+    r->status = STREAM_OK;
+    return true;
+}
+
+// 读取一个浮点数，记号复制到栈上的小数组后交给strtod
+bool stream_read_double(struct stream_reader* r, double* out) {
+    if (!stream_next_token(r)) {
+        return false;
+    }
+    
+    size_t n = stream_token_length(r);
+    if (n == 0) {
+        return stream_fail(r, STREAM_ERR_TOO_LONG, r->pos);
+    }
+    
+    char token[STREAM_MAX_TOKEN + 1];
+    memcpy(token, r->buf + r->pos, n);
+    token[n] = '\0';
+    
+    char* parse_end;
+    errno = 0;
+    double value = strtod(token, &parse_end);
+    if (parse_end == token || *parse_end != '\0') {
+        return stream_fail(r, STREAM_ERR_SYNTAX, r->pos + (size_t)(parse_end - token));
+    }
+    if (errno == ERANGE && (value == HUGE_VAL || value == -HUGE_VAL)) {
+        return stream_fail(r, STREAM_ERR_RANGE, r->pos);
+    }
+    
+    *out = value;
+    r->pos += n;
+    r->status = STREAM_OK;
+    return true;
+}
+
+bool stream_read_float(struct stream_reader* r, float* out) {
+    double value;
+    size_t start;
+    
+    if (!stream_next_token(r)) {
+        return false;
+    }
+    start = r->pos;
+    if (!stream_read_double(r, &value)) {
+        return false;
+    }
+    // 只有舍入到float后溢出才算超出范围，3.40282347e+38等仍舍入为FLT_MAX
+    if (isfinite(value) && isinf((float)value)) {
+        r->pos = start;                 // 与其他错误一致，停在出错的记号上
+        return stream_fail(r, STREAM_ERR_RANGE, start);
+    }
+    *out = (float)value;
+    return true;
+}
+
+// 读取下一个非空白字符，等价于 scanf(" %c")
+bool stream_read_char(struct stream_reader* r, char* out) {
+    if (!stream_next_token(r)) {
+        return false;
+    }
+    *out = r->buf[r->pos++];
+    r->status = STREAM_OK;
+    return true;
+}
+
+void stream_print_error(const struct stream_reader* r, const char* name) {
+    fprintf(stderr, "%s:%" PRIu64 ":%" PRIu64 ": %s (字节偏移 %" PRIu64 ")\n",
+            name, r->err_line, r->err_column,
+            stream_status_string(r->status), r->err_offset);
+}
+
+// 生成测试输入：每行 "整数 整数 浮点数"，返回行数
+static uint64_t generate_parse_input(FILE* fp, uint64_t bytes) {
+    uint64_t seed = 0x2545F4914F6CDD1DULL;
+    uint64_t written = 0;
+    uint64_t lines = 0;
+    
+    while (written < bytes) {
+        uint64_t r = xorshift64(&seed);
+        int n = fprintf(fp, "%" PRId64 " %d %.6f\n",
+                        (int64_t)(r >> 20) - (INT64_C(1) << 43),
+                        (int)(r & 0xFFFF) - 32768,
+                        (double)(r >> 40) / 1024.0);
+        if (n < 0) {
+            break;
+        }
+        written += (uint64_t)n;
+        lines++;
+    }
+    fflush(fp);
+    return lines;
+}
+
+static void report_parse(const char* name, uint64_t lines, double checksum,
+                         clock_t start, clock_t end, uint64_t bytes) {
+    double seconds = ((double)(end - start)) / CLOCKS_PER_SEC;
+    printf("%-18s %12.0f 行/秒 %8.1f MB/s  校验和 %.6e\n", name,
+           seconds > 0 ? lines / seconds : 0.0,
+           seconds > 0 ? bytes / seconds / 1e6 : 0.0, checksum);
+}
+
+// scanf、fgets+strtol与流式解析器的吞吐量对比
+void input_parser_benchmark(uint64_t megabytes) {
+    PROFILE_FUNCTION();
+    SECTION_HEADER("输入解析性能测试");
+    
+    FILE* fp = tmpfile();
+    if (!fp) {
+        printf("无法创建临时文件\n");
+        return;
+    }
+    
+    uint64_t bytes = megabytes * 1024 * 1024;
+    uint64_t lines = generate_parse_input(fp, bytes);
+    printf("测试输入: %" PRIu64 "行, %" PRIu64 "MB\n\n", lines, megabytes);
+    
+    long long a, b;
+    double x;
+    double checksum;
+    uint64_t count;
+    clock_t start;
+    
+    // 1. fscanf
+    rewind(fp);
+    checksum = 0;
+    count = 0;
+    start = clock();
+    while (fscanf(fp, "%lld %lld %lf", &a, &b, &x) == 3) {
+        checksum += (double)(a + b) + x;
+        count++;
+    }
+    report_parse("scanf", count, checksum, start, clock(), bytes);
+    
+    // 2. fgets + strtoll/strtod
+    rewind(fp);
+    checksum = 0;
+    count = 0;
+    start = clock();
+    char line[256];
+    while (fgets(line, sizeof(line), fp)) {
+        char* p = line;
+        a = strtoll(p, &p, 10);
+        b = strtoll(p, &p, 10);
+        x = strtod(p, &p);
+        checksum += (double)(a + b) + x;
+        count++;
+    }
+    report_parse("fgets+strtol", count, checksum, start, clock(), bytes);
+    
+    // 3. 流式解析器（直接对底层文件描述符read）
+    static struct stream_reader reader;
+    int fd = fileno(fp);
+    lseek(fd, 0, SEEK_SET);
+    stream_reader_init(&reader, fd);
+    checksum = 0;
+    start = clock();
+    while (stream_read_int(&reader, &a) &&
+           stream_read_int(&reader, &b) &&
+           stream_read_double(&reader, &x)) {
+        checksum += (double)(a + b) + x;
+    }
+    clock_t end = clock();
+    if (reader.status != STREAM_EOF) {
+        stream_print_error(&reader, "<临时文件>");
+    }
+    report_parse("stream_reader", reader.line - 1, checksum, start, end, bytes);
+    
+    fclose(fp);
+}
+
+/*
+ * ========================================
+ * 13. 异步输出：无锁环形缓冲区 + 写线程
+ * ========================================
+ *
+ * 计算线程直接printf到stdout时，如果stdout是一个很慢的管道，
+ * 计算会被write()阻塞。这里把格式化好的输出块放入有界的无锁
+ * 环形缓冲区，由专门的写线程取出后用writev()批量写出。
+ *
+ * 每个槽位带一个序号 (Vyukov有界队列)：
+ *   seq == pos         槽位空闲，可以写入位置pos
+ *   seq == pos + 1     已写入，等待写线程取走
+ * 单生产者(SPSC)直接推进tail；多生产者(MPSC)用CAS争抢tail。
+ * 缓冲区满时的处理策略：阻塞等待、丢弃消息或忙等。
+ * 运行教程时加 --async，各节的输出就经由这里的写线程写出。
+ */
+#ifdef HAVE_PTHREAD
+
+#define RING_SLOT_DATA    236       // 使每个槽位正好256字节
+#define RING_WRITEV_BATCH 64        // 每次writev最多合并的槽位数
+
+#if defined(__x86_64__) || defined(__i386__)
+#define cpu_relax() __builtin_ia32_pause()
+#else
+#define cpu_relax() ((void)0)
+#endif
+
+enum ring_mode { RING_SPSC, RING_MPSC };
+enum ring_policy { RING_BLOCK, RING_DROP, RING_SPIN };
+
+struct ring_slot {
+    uint64_t seq;
+    uint64_t stamp;                 // 入队时间(ns)，用于延迟统计
+    uint32_t len;
+    char data[RING_SLOT_DATA];
+};
+
+struct output_ring {
+    struct ring_slot* slots;
+    uint64_t mask;
+    enum ring_mode mode;
+    enum ring_policy policy;
+    int fd;
+    
+    // tail和head分别由生产者和写线程修改，放在不同的缓存行避免伪共享
+    char pad0[64];
+    uint64_t tail;
+    char pad1[64];
+    uint64_t head;
+    char pad2[64];
+    
+    int producers_waiting;
+    int writer_sleeping;
+    int closing;
+    pthread_mutex_t lock;
+    pthread_cond_t not_full;
+    pthread_cond_t not_empty;
+    pthread_t writer;
+    
+    // 统计
+    uint64_t dropped;
+    uint64_t writev_calls;
+    uint64_t bytes_written;
+    bool write_failed;
+    int write_errno;                // 写出失败时的errno
+    uint64_t* latencies;            // 可选：记录每条消息从入队到写出的延迟
+    size_t latency_capacity;
+    size_t latency_count;
+};
+
+static void ring_writev_all(struct output_ring* r, struct iovec* iov, int count) {
+    while (count > 0 && !r->write_failed) {
+        ssize_t n = writev(r->fd, iov, count);
+        r->writev_calls++;
+        if (n < 0) {
+            if (errno != EINTR) {
+                r->write_failed = true;
+                r->write_errno = errno;
+            }
+            continue;
+        }
+        r->bytes_written += (uint64_t)n;
+        // 跳过已完整写出的iovec，调整部分写出的那一个
+        while (count > 0 && (size_t)n >= iov->iov_len) {
+            n -= (ssize_t)iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (char*)iov->iov_base + n;
+            iov->iov_len -= (size_t)n;
+        }
+    }
+}
+
+/*
+ * 睡眠与唤醒（Dekker式握手，双方都是"先写自己的标志，再读对方的状态"）：
+ *   写线程  writer_sleeping = 1; 读slot->seq      （均为seq_cst）
+ *   生产者  slot->seq = pos + 1; 读writer_sleeping （均为seq_cst）
+ *   生产者  producers_waiting++; fence; 读slot->seq
+ *   写线程  slot->seq = 空闲;    fence; 读producers_waiting
+ * seq_cst保证每对中至少一方看到对方的写入；等待方在mutex下检查后
+ * 才进入pthread_cond_wait，唤醒方也在mutex下signal，所以不会丢失唤醒。
+ */
+static void* ring_writer_main(void* arg) {
+    struct output_ring* r = (struct output_ring*)arg;
+    struct iovec iov[RING_WRITEV_BATCH];
+    
+    for (;;) {
+        int closing = __atomic_load_n(&r->closing, __ATOMIC_ACQUIRE);
+        uint64_t head = r->head;
+        int n = 0;
+        
+        while (n < RING_WRITEV_BATCH) {
+            struct ring_slot* slot = &r->slots[(head + n) & r->mask];
+            if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != head + n + 1) {
+                break;
+            }
+            iov[n].iov_base = slot->data;
+            iov[n].iov_len = slot->len;
+            n++;
+        }
+        
+        if (n == 0) {
+            if (closing) {
+                break;              // 关闭后已全部写出
+            }
+            // 空闲：短暂忙等后在条件变量上睡眠，生产者入队时唤醒
+            struct ring_slot* next = &r->slots[head & r->mask];
+            int spins = 0;
+            while (spins++ < 256 &&
+                   __atomic_load_n(&next->seq, __ATOMIC_ACQUIRE) != head + 1) {
+                cpu_relax();
+            }
+            pthread_mutex_lock(&r->lock);
+            __atomic_store_n(&r->writer_sleeping, 1, __ATOMIC_SEQ_CST);
+            if (__atomic_load_n(&next->seq, __ATOMIC_SEQ_CST) != head + 1 &&
+                !__atomic_load_n(&r->closing, __ATOMIC_SEQ_CST)) {
+                pthread_cond_wait(&r->not_empty, &r->lock);
+            }
+            __atomic_store_n(&r->writer_sleeping, 0, __ATOMIC_RELAXED);
+            pthread_mutex_unlock(&r->lock);
+            continue;
+        }
+        
+        ring_writev_all(r, iov, n);
+        
+        if (r->latencies) {
+            uint64_t now = monotonic_ns();
+            for (int i = 0; i < n && r->latency_count < r->latency_capacity; i++) {
+                struct ring_slot* slot = &r->slots[(head + i) & r->mask];
+                r->latencies[r->latency_count++] = now - slot->stamp;
+            }
+        }
+        
+        // 写出后才释放槽位，writev期间数据保持有效
+        for (int i = 0; i < n; i++) {
+            struct ring_slot* slot = &r->slots[(head + i) & r->mask];
+            __atomic_store_n(&slot->seq, head + i + r->mask + 1, __ATOMIC_RELEASE);
+        }
+        r->head = head + n;
+        
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&r->producers_waiting, __ATOMIC_RELAXED)) {
+            pthread_mutex_lock(&r->lock);
+            pthread_cond_broadcast(&r->not_full);
+            pthread_mutex_unlock(&r->lock);
+        }
+    }
+    return NULL;
+}
+
+// capacity必须是2的幂；成功返回0
+int output_ring_init(struct output_ring* r, int fd, size_t capacity,
+                     enum ring_mode mode, enum ring_policy policy) {
+    memset(r, 0, sizeof(*r));
+    if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+        return -1;
+    }
+    r->slots = malloc(capacity * sizeof(struct ring_slot));
+    if (!r->slots) {
+        return -1;
+    }
+    for (size_t i = 0; i < capacity; i++) {
+        r->slots[i].seq = i;
+    }
+    r->mask = capacity - 1;
+    r->mode = mode;
+    r->policy = policy;
+    r->fd = fd;
+    pthread_mutex_init(&r->lock, NULL);
+    pthread_cond_init(&r->not_full, NULL);
+    pthread_cond_init(&r->not_empty, NULL);
+    
+    if (pthread_create(&r->writer, NULL, ring_writer_main, r) != 0) {
+        pthread_mutex_destroy(&r->lock);
+        pthread_cond_destroy(&r->not_full);
+        pthread_cond_destroy(&r->not_empty);
+        free(r->slots);
+        r->slots = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+// 尝试占用一个空闲槽位，缓冲区满时返回NULL
+static struct ring_slot* ring_try_claim(struct output_ring* r, uint64_t* pos_out) {
+    if (r->mode == RING_SPSC) {
+        uint64_t pos = r->tail;
+        struct ring_slot* slot = &r->slots[pos & r->mask];
+        if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != pos) {
+            return NULL;
+        }
+        r->tail = pos + 1;
+        *pos_out = pos;
+        return slot;
+    }
+    
+    uint64_t pos = __atomic_load_n(&r->tail, __ATOMIC_RELAXED);
+    for (;;) {
+        struct ring_slot* slot = &r->slots[pos & r->mask];
+        uint64_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        int64_t diff = (int64_t)(seq - pos);
+        
+        if (diff == 0) {
+            // 失败时pos被更新为最新的tail
+            if (__atomic_compare_exchange_n(&r->tail, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                *pos_out = pos;
+                return slot;
+            }
+        } else if (diff < 0) {
+            return NULL;            // 写线程还没取走这一圈的数据
+        } else {
+            pos = __atomic_load_n(&r->tail, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+// 按策略占用槽位；RING_DROP且缓冲区满时返回NULL
+static struct ring_slot* ring_claim(struct output_ring* r, uint64_t* pos) {
+    struct ring_slot* slot = ring_try_claim(r, pos);
+    if (slot) {
+        return slot;
+    }
+    
+    switch (r->policy) {
+        case RING_DROP:
+            __atomic_fetch_add(&r->dropped, 1, __ATOMIC_RELAXED);
+            return NULL;
+        case RING_SPIN:
+            // 不睡眠；长时间自旋时让出CPU，避免线程数多于核数时饿死写线程
+            for (unsigned spins = 1; !(slot = ring_try_claim(r, pos)); spins++) {
+                if (spins % 1024 == 0) {
+                    sched_yield();
+                } else {
+                    cpu_relax();
+                }
+            }
+            return slot;
+        case RING_BLOCK:
+            for (int spins = 0; spins < 128; spins++) {
+                cpu_relax();
+                if ((slot = ring_try_claim(r, pos))) {
+                    return slot;
+                }
+            }
+            pthread_mutex_lock(&r->lock);
+            __atomic_fetch_add(&r->producers_waiting, 1, __ATOMIC_SEQ_CST);
+            // 与写线程释放槽位后的fence配对，之后ring_try_claim的读取不会被提前
+            __atomic_thread_fence(__ATOMIC_SEQ_CST);
+            while (!(slot = ring_try_claim(r, pos))) {
+                pthread_cond_wait(&r->not_full, &r->lock);
+            }
+            __atomic_fetch_sub(&r->producers_waiting, 1, __ATOMIC_SEQ_CST);
+            pthread_mutex_unlock(&r->lock);
+            return slot;
+    }
+    return NULL;
+}
+
+static void ring_publish(struct output_ring* r, struct ring_slot* slot, uint64_t pos) {
+    __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&r->writer_sleeping, __ATOMIC_SEQ_CST)) {
+        pthread_mutex_lock(&r->lock);
+        pthread_cond_signal(&r->not_empty);
+        pthread_mutex_unlock(&r->lock);
+    }
+}
+
+// 写入一块输出，超过一个槽位时拆分；有数据被丢弃时返回false
+// MPSC模式下，不同生产者的长输出拆分后可能交错
+bool output_ring_write(struct output_ring* r, const char* data, size_t len) {
+    bool complete = true;
+    
+    while (len > 0) {
+        size_t n = (len < RING_SLOT_DATA) ? len : RING_SLOT_DATA;
+        uint64_t pos;
+        struct ring_slot* slot = ring_claim(r, &pos);
+        
+        if (slot) {
+            memcpy(slot->data, data, n);
+            slot->len = (uint32_t)n;
+            slot->stamp = r->latencies ? monotonic_ns() : 0;
+            ring_publish(r, slot, pos);
+        } else {
+            complete = false;
+        }
+        data += n;
+        len -= n;
+    }
+    return complete;
+}
+
+// 等待写线程写完所有数据后退出，并释放缓冲区（不关闭fd）
+void output_ring_close(struct output_ring* r) {
+    pthread_mutex_lock(&r->lock);
+    __atomic_store_n(&r->closing, 1, __ATOMIC_SEQ_CST);
+    pthread_cond_signal(&r->not_empty);
+    pthread_mutex_unlock(&r->lock);
+    
+    pthread_join(r->writer, NULL);
+    pthread_mutex_destroy(&r->lock);
+    pthread_cond_destroy(&r->not_full);
+    pthread_cond_destroy(&r->not_empty);
+    free(r->slots);
+    r->slots = NULL;
+}
+
+/*
+ * 性能测试：写线程的目标是一个管道，管道另一端的读线程
+ * 每读4KB就休眠一段时间，模拟很慢的下游。
+ */
+struct slow_reader_args {
+    int fd;
+    long delay_ns;
+};
+
+static void* slow_reader_main(void* arg) {
+    struct slow_reader_args* a = (struct slow_reader_args*)arg;
+    char buf[4096];
+    struct timespec delay = {0, a->delay_ns};
+    
+    while (read(a->fd, buf, sizeof(buf)) > 0) {
+        nanosleep(&delay, NULL);
+    }
+    return NULL;
+}
+
+struct ring_producer_args {
+    struct output_ring* ring;
+    int id;
+    int messages;
+};
+
+static void* ring_producer_main(void* arg) {
+    struct ring_producer_args* a = (struct ring_producer_args*)arg;
+    char msg[64];
+    
+    for (int i = 0; i < a->messages; i++) {
+        int n = snprintf(msg, sizeof(msg), "producer %d message %08d ", a->id, i);
+        memset(msg + n, '.', sizeof(msg) - 1 - (size_t)n);
+        msg[sizeof(msg) - 1] = '\n';
+        output_ring_write(a->ring, msg, sizeof(msg));
+    }
+    return NULL;
+}
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static void run_ring_case(enum ring_mode mode, int producers,
+                          enum ring_policy policy, const char* policy_name) {
+    const int messages = 100000;
+    const size_t total = (size_t)producers * messages;
+    int fds[2];
+    
+    if (pipe(fds) != 0) {
+        printf("pipe()失败: %s\n", strerror(errno));
+        return;
+    }
+    
+    struct slow_reader_args reader_args = {fds[0], 20000};
+    pthread_t reader;
+    pthread_create(&reader, NULL, slow_reader_main, &reader_args);
+    
+    static struct output_ring ring;
+    if (output_ring_init(&ring, fds[1], 1024, mode, policy) != 0) {
+        printf("环形缓冲区初始化失败\n");
+        close(fds[1]);
+        pthread_join(reader, NULL);
+        close(fds[0]);
+        return;
+    }
+    ring.latencies = malloc(total * sizeof(uint64_t));
+    ring.latency_capacity = ring.latencies ? total : 0;
+    
+    pthread_t threads[8];
+    struct ring_producer_args args[8];
+    uint64_t start = monotonic_ns();
+    for (int i = 0; i < producers; i++) {
+        args[i].ring = &ring;
+        args[i].id = i;
+        args[i].messages = messages;
+        pthread_create(&threads[i], NULL, ring_producer_main, &args[i]);
+    }
+    for (int i = 0; i < producers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    uint64_t produced = monotonic_ns();
+    output_ring_close(&ring);
+    
+    close(fds[1]);
+    pthread_join(reader, NULL);
+    close(fds[0]);
+    
+    double seconds = (produced - start) / 1e9;
+    size_t n = ring.latency_count;
+    qsort(ring.latencies, n, sizeof(uint64_t), compare_u64);
+    
+    printf("%-5s %d  %-6s %12.0f %9" PRIu64 " %7.1f %9.1f %9.1f %9.1f %10.1f\n",
+           mode == RING_SPSC ? "SPSC" : "MPSC", producers, policy_name,
+           seconds > 0 ? total / seconds : 0.0, ring.dropped,
+           ring.writev_calls ? (double)n / ring.writev_calls : 0.0,
+           n ? ring.latencies[n / 2] / 1e3 : 0.0,
+           n ? ring.latencies[n * 99 / 100] / 1e3 : 0.0,
+           n ? ring.latencies[n * 999 / 1000] / 1e3 : 0.0,
+           n ? ring.latencies[n - 1] / 1e3 : 0.0);
+    free(ring.latencies);
+}
+
+void async_output_benchmark() {
+    PROFILE_FUNCTION();
+    SECTION_HEADER("异步输出性能测试");
+    
+    printf("每个生产者发送100000条64字节消息，环形缓冲区1024个槽位\n");
+    printf("下游管道每读4KB休眠20us；延迟为入队到writev完成，单位us\n\n");
+    printf("%-5s %-2s %-6s %12s %9s %7s %9s %9s %9s %10s\n",
+           "模式", "P", "策略", "消息/秒", "丢弃", "批大小",
+           "p50", "p99", "p99.9", "max");
+    
+    static const struct {
+        enum ring_policy policy;
+        const char* name;
+    } policies[] = {
+        {RING_BLOCK, "block"},
+        {RING_SPIN,  "spin"},
+        {RING_DROP,  "drop"},
+    };
+    
+    for (size_t i = 0; i < sizeof(policies) / sizeof(policies[0]); i++) {
+        run_ring_case(RING_SPSC, 1, policies[i].policy, policies[i].name);
+    }
+    for (size_t i = 0; i < sizeof(policies) / sizeof(policies[0]); i++) {
+        run_ring_case(RING_MPSC, 4, policies[i].policy, policies[i].name);
+    }
+}
+
+/*
+ * 把stdout接到环形缓冲区 (--async)：各节的printf照常在stdio中缓冲，
+ * 缓冲区满或fflush时整块交给写线程，计算线程不再直接调用write()。
+ * glibc用fopencookie，BSD/macOS用funopen创建自定义FILE。
+ */
+#if defined(__GLIBC__) || defined(__APPLE__) || defined(__FreeBSD__)
+#define HAVE_STDOUT_RING 1
+
+static struct output_ring stdout_ring;
+static FILE* stdout_saved;
+
+#ifdef __GLIBC__
+static ssize_t stdout_ring_write(void* cookie, const char* buf, size_t size) {
+    return output_ring_write(cookie, buf, size) ? (ssize_t)size : -1;
+}
+#else
+static int stdout_ring_write(void* cookie, const char* buf, int size) {
+    return output_ring_write(cookie, buf, (size_t)size) ? size : -1;
+}
+#endif
+
+// 成功后stdout的内容都经由写线程输出，直到stdout_ring_stop()
+bool stdout_ring_start() {
+    fflush(stdout);
+    if (output_ring_init(&stdout_ring, 1, 1024, RING_SPSC, RING_BLOCK) != 0) {
+        return false;
+    }
+#ifdef __GLIBC__
+    cookie_io_functions_t io = {NULL, stdout_ring_write, NULL, NULL};
+    FILE* ring_stream = fopencookie(&stdout_ring, "w", io);
+#else
+    FILE* ring_stream = funopen(&stdout_ring, NULL, stdout_ring_write, NULL, NULL);
+#endif
+    if (!ring_stream) {
+        output_ring_close(&stdout_ring);
+        return false;
+    }
+    stdout_saved = stdout;
+    stdout = ring_stream;
+    return true;
+}
+
+// 写出剩余内容，等待写线程结束并恢复原来的stdout
+void stdout_ring_stop() {
+    fclose(stdout);
+    stdout = stdout_saved;
+    output_ring_close(&stdout_ring);
+    if (stdout_ring.write_failed) {
+        fprintf(stderr, "写入输出失败: %s\n", strerror(stdout_ring.write_errno));
+    }
+}
+#endif
+
+#endif /* HAVE_PTHREAD */
+
+/*
+ * ========================================
+ * 14. 批量输入验证模式
+ * ========================================
+ *
+ * 把run_interactive_tests()中的三个交互检查改为批处理：
+ * 从文件或标准输入读取大量数值，逐个执行同样的检查，
+ * 结果写入固定大小的输出缓冲区，缓冲区满时才调用一次write(2)。
+ *
+ * 用法: basic_types --batch int|char|float [文件] [--async]
+ */
+
+#define OUTPUT_BUFFER_SIZE (64 * 1024)
+#define OUTPUT_MAX_RECORD  256          // 单条结果的最大长度
+
+struct output_buffer {
+    int fd;
+    size_t len;
+    bool failed;
+    int error;                  // 写出失败时的errno
+    struct output_ring* ring;   // 非空时交给写线程输出（第13节）
+    char buf[OUTPUT_BUFFER_SIZE];
+};
+
+void output_init(struct output_buffer* o, int fd) {
+    o->fd = fd;
+    o->len = 0;
+    o->failed = false;
+    o->error = 0;
+    o->ring = NULL;
+}
+
+void output_flush(struct output_buffer* o) {
+    size_t done = 0;
+    
+#ifdef HAVE_PTHREAD
+    if (o->ring) {
+        output_ring_write(o->ring, o->buf, o->len);
+        o->len = 0;
+        return;
+    }
+#endif
+    
+    while (done < o->len && !o->failed) {
+        ssize_t n = write(o->fd, o->buf + done, o->len - done);
+        if (n > 0) {
+            done += (size_t)n;
+        } else if (n < 0 && errno != EINTR) {
+            o->failed = true;
+            o->error = errno;
+        }
+    }
+    o->len = 0;
+}
+
+// 保证缓冲区至少还有n字节空间，返回写入位置
+static inline char* output_reserve(struct output_buffer* o, size_t n) {
+    if (OUTPUT_BUFFER_SIZE - o->len < n) {
+        output_flush(o);
+    }
+    return o->buf + o->len;
+}
+
+// 检查1: 整数的十进制、十六进制和按4位分组的二进制
+static size_t render_int_record(char* p, int number) {
+    char* start = p;
+    unsigned int u = (unsigned int)number;
+    
+    p += sprintf(p, "%d\t0x", number);
+    
+    // 十六进制：去掉前导零（同%x），最高字节可能只有1位
+    int top = 3;
+    while (top > 0 && ((u >> (8 * top)) & 0xFF) == 0) {
+        top--;
+    }
+    const char* pair = HEX_PAIR(u >> (8 * top));
+    if (((u >> (8 * top)) & 0xFF) >= 0x10) {
+        *p++ = pair[0];
+    }
+    *p++ = pair[1];
+    for (int k = top - 1; k >= 0; k--) {
+        memcpy(p, HEX_PAIR(u >> (8 * k)), 2);
+        p += 2;
+    }
+    
+    // 二进制：每字节查表得到8位，中间插入空格
+    *p++ = '\t';
+    for (int k = 3; k >= 0; k--) {
+        const char* bits = BINARY(u >> (8 * k));
+        memcpy(p, bits, 4);
+        p[4] = ' ';
+        memcpy(p + 5, bits + 4, 4);
+        p[9] = ' ';
+        p += 10;
+    }
+    p[-1] = '\n';
+    return (size_t)(p - start);
+}
+
+// 检查2: 字符分类与大小写转换
+static size_t render_char_record(char* p, char ch) {
+    const char* kind;
+    char converted = ch;
+    
+    if (CHAR_IS(ch, CHAR_ALPHA)) {
+        if (CHAR_IS(ch, CHAR_LOWER)) {
+            kind = "小写字母";
+            converted = CHAR_TO_UPPER(ch);
+        } else {
+            kind = "大写字母";
+            converted = CHAR_TO_LOWER(ch);
+        }
+    } else if (CHAR_IS(ch, CHAR_DIGIT)) {
+        kind = "数字";
+    } else {
+        kind = "特殊字符";
+    }
+    return (size_t)sprintf(p, "%c\t%d\t%s\t%c\n", ch, ch, kind, converted);
+}
+
+// 检查3: 输入值按float存储后与double的差异
+static size_t render_float_record(char* p, double value) {
+    float f_val = (float)value;
+    double d_val = f_val;
+    return (size_t)sprintf(p, "%.9g\t%.17g\t%e\n",
+                           f_val, value, fabs(value - d_val));
+}
+
+enum batch_kind { BATCH_INT, BATCH_CHAR, BATCH_FLOAT };
+
+// 执行批量检查，统计信息输出到stderr
+// async为true时通过写线程异步输出
+// 返回进程退出码：全部有效为0，有无效值或读写失败为1
+int run_batch_validation(enum batch_kind kind, int in_fd, int out_fd,
+                         const char* name, bool async) {
+    PROFILE_FUNCTION();
+    static struct stream_reader in;
+    static struct output_buffer out;
+    uint64_t valid = 0;
+    uint64_t invalid = 0;
+    
+    stream_reader_init(&in, in_fd);
+    output_init(&out, out_fd);
+    
+#ifdef HAVE_PTHREAD
+    static struct output_ring ring;
+    if (async) {
+        if (output_ring_init(&ring, out_fd, 1024, RING_SPSC, RING_BLOCK) == 0) {
+            out.ring = &ring;
+        } else {
+            fprintf(stderr, "无法启动写线程，改为同步输出\n");
+        }
+    }
+#else
+    if (async) {
+        fprintf(stderr, "本平台不支持异步输出，改为同步输出\n");
+    }
+#endif
+    
+    // 用墙上时间：输入来自慢速生产者时，CPU时间会严重高估速度
+    uint64_t start = monotonic_ns();
+    for (;;) {
+        bool ok = false;
+        
+        if (kind == BATCH_INT) {
+            long long value;
+            if (stream_next_token(&in)) {
+                size_t token_start = in.pos;
+                ok = stream_read_int(&in, &value);
+                if (ok && (value < INT_MIN || value > INT_MAX)) {
+                    in.pos = token_start;       // 留给下面的stream_skip_token跳过
+                    ok = stream_fail(&in, STREAM_ERR_RANGE, token_start);
+                }
+                if (ok) {
+                    char* p = output_reserve(&out, OUTPUT_MAX_RECORD);
+                    out.len += render_int_record(p, (int)value);
+                }
+            }
+        } else if (kind == BATCH_CHAR) {
+            char ch;
+            ok = stream_read_char(&in, &ch);
+            if (ok) {
+                char* p = output_reserve(&out, OUTPUT_MAX_RECORD);
+                out.len += render_char_record(p, ch);
+            }
+        } else {
+            double value;
+            if (stream_next_token(&in)) {
+                size_t token_start = in.pos;
+                ok = stream_read_double(&in, &value);
+                // 与stream_read_float相同的范围检查，但保留double值用于比较
+                if (ok && isfinite(value) && isinf((float)value)) {
+                    in.pos = token_start;
+                    ok = stream_fail(&in, STREAM_ERR_RANGE, token_start);
+                }
+            }
+            if (ok) {
+                char* p = output_reserve(&out, OUTPUT_MAX_RECORD);
+                out.len += render_float_record(p, value);
+            }
+        }
+        
+        if (ok) {
+            valid++;
+            continue;
+        }
+        if (in.status == STREAM_EOF || in.status == STREAM_ERR_IO) {
+            break;
+        }
+        // 无效输入：报告位置后跳过该记号继续
+        stream_print_error(&in, name);
+        stream_skip_token(&in);
+        invalid++;
+    }
+    output_flush(&out);
+    
+#ifdef HAVE_PTHREAD
+    if (out.ring) {
+        output_ring_close(&ring);       // 计时包含写线程写完剩余数据
+        out.failed = ring.write_failed;
+        out.error = ring.write_errno;
+    }
+#endif
+    uint64_t end = monotonic_ns();
+    
+    if (in.status == STREAM_ERR_IO) {
+        stream_print_error(&in, name);
+    }
+    if (out.failed) {
+        fprintf(stderr, "写入输出失败: %s\n", strerror(out.error));
+    }
+    
+    double seconds = (double)(end - start) / 1e9;
+    fprintf(stderr, "批量验证: %" PRIu64 "个有效值, %" PRIu64 "个无效值, "
+            "用时%.3f秒, %.0f 值/秒\n", valid, invalid, seconds,
+            seconds > 0 ? (valid + invalid) / seconds : 0.0);
+    
+    bool failed = invalid > 0 || in.status == STREAM_ERR_IO || out.failed;
+    return failed ? 1 : 0;
+}
+
+// 解析 --batch 的参数，返回进程退出码
+// async为true时由写线程输出（--async由main取出，可以写在任意位置）
+int batch_main(int argc, char* argv[], bool async) {
+    enum batch_kind kind;
+    
+    if (argc < 3 || argc > 4) {
+        fprintf(stderr, "用法: %s [--async] --batch int|char|float [文件]\n", argv[0]);
+        return 2;
+    }
+    if (strcmp(argv[2], "int") == 0) {
+        kind = BATCH_INT;
+    } else if (strcmp(argv[2], "char") == 0) {
+        kind = BATCH_CHAR;
+    } else if (strcmp(argv[2], "float") == 0) {
+        kind = BATCH_FLOAT;
+    } else {
+        fprintf(stderr, "未知的检查类型: %s\n", argv[2]);
+        return 2;
+    }
+    
+    int fd = 0;
+    const char* name = "<stdin>";
+    if (argc > 3 && strcmp(argv[3], "-") != 0) {
+        name = argv[3];
+        fd = open(name, O_RDONLY);
+        if (fd < 0) {
+            fprintf(stderr, "无法打开 %s: %s\n", name, strerror(errno));
+            return 1;
+        }
+    }
+    
+    int status = run_batch_validation(kind, fd, 1, name, async);
+    
+    if (fd != 0) {
+        close(fd);
+    }
+    return status;
+}
+
+/*
+ * ========================================
+ * 15. 字节查找表性能测试
+ * ========================================
+ *
+ * 对比逐字节计算（printf格式化、位测试、<ctype.h>函数）与
+ * 文件开头的查找表。Linux下用perf_event硬件计数器统计L1数据
+ * 缓存缺失：若查表循环的缺失数与单纯顺序读取输入相当，
+ * 说明这几张表一直驻留在L1中。
+ */
+
+// 硬件性能计数器，不支持或无权限时返回-1
+static int perf_counter_open(uint32_t type, uint64_t config) {
+#ifdef __linux__
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = type;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+    (void)type;
+    (void)config;
+    return -1;
+#endif
+}
+
+static void perf_counter_start(int fd) {
+#ifdef __linux__
+    if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#else
+    (void)fd;
+#endif
+}
+
+static uint64_t perf_counter_stop(int fd) {
+    uint64_t value = 0;
+#ifdef __linux__
+    if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd, &value, sizeof(value)) != (ssize_t)sizeof(value)) {
+            value = 0;
+        }
+    }
+#else
+    (void)fd;
+#endif
+    return value;
+}
+
+// 原来逐位计算的二进制渲染，作为对照
+#define BINARY_BITS(byte) \
+    (byte & 0x80 ? '1' : '0'), \
+    (byte & 0x40 ? '1' : '0'), \
+    (byte & 0x20 ? '1' : '0'), \
+    (byte & 0x10 ? '1' : '0'), \
+    (byte & 0x08 ? '1' : '0'), \
+    (byte & 0x04 ? '1' : '0'), \
+    (byte & 0x02 ? '1' : '0'), \
+    (byte & 0x01 ? '1' : '0')
+
+enum table_workload {
+    WORK_SCAN,              // 只顺序读取输入（缓存缺失基线）
+    WORK_HEX_PRINTF,
+    WORK_HEX_TABLE,
+    WORK_BINARY_BITS,
+    WORK_BINARY_TABLE,
+    WORK_PRINT_COMPARE,
+    WORK_PRINT_TABLE,
+    WORK_CTYPE,
+    WORK_CLASS_TABLE
+};
+
+static volatile uint64_t table_bench_sink;
+
+// 对输入执行一种逐字节处理，结果写入循环使用的小输出缓冲区
+static void run_table_workload(enum table_workload work,
+                               const unsigned char* in, size_t n) {
+    static char out[4096 + 16];
+    size_t o = 0;
+    uint64_t sum = 0;
+    
+    for (size_t i = 0; i < n; i++) {
+        unsigned char b = in[i];
+        switch (work) {
+            case WORK_SCAN:
+                sum += b;
+                break;
+            case WORK_HEX_PRINTF:
+                sprintf(out + o, "%02x", b);
+                o += 2;
+                break;
+            case WORK_HEX_TABLE:
+                memcpy(out + o, HEX_PAIR(b), 2);
+                o += 2;
+                break;
+            case WORK_BINARY_BITS: {
+                char bits[8] = {BINARY_BITS(b)};
+                memcpy(out + o, bits, 8);
+                o += 8;
+                break;
+            }
+            case WORK_BINARY_TABLE:
+                memcpy(out + o, BINARY(b), 8);
+                o += 8;
+                break;
+            case WORK_PRINT_COMPARE:
+                out[o++] = (b >= 32 && b < 127) ? (char)b : '.';
+                break;
+            case WORK_PRINT_TABLE:
+                out[o++] = CHAR_IS(b, CHAR_PRINT) ? (char)b : '.';
+                break;
+            case WORK_CTYPE:
+                sum += (isalpha(b) != 0) + (isdigit(b) != 0) + (isalnum(b) != 0) +
+                       (isspace(b) != 0) + (isupper(b) != 0) + (islower(b) != 0);
+                break;
+            case WORK_CLASS_TABLE: {
+                unsigned char m = char_class_table[b];
+                sum += ((m & CHAR_ALPHA) != 0) + ((m & CHAR_DIGIT) != 0) +
+                       ((m & CHAR_ALNUM) != 0) + ((m & CHAR_SPACE) != 0) +
+                       ((m & CHAR_UPPER) != 0) + ((m & CHAR_LOWER) != 0);
+                break;
+            }
+        }
+        if (o >= 4096) {
+            sum += (unsigned char)out[o - 1];
+            o = 0;
+        }
+    }
+    table_bench_sink += sum + o;
+}
+
+void lookup_table_benchmark() {
+    PROFILE_FUNCTION();
+    SECTION_HEADER("字节查找表性能测试");
+    
+    static const struct {
+        enum table_workload work;
+        const char* name;
+    } cases[] = {
+        {WORK_SCAN,          "顺序读取(基线)"},
+        {WORK_HEX_PRINTF,    "十六进制 sprintf"},
+        {WORK_HEX_TABLE,     "十六进制 查表"},
+        {WORK_BINARY_BITS,   "二进制 逐位"},
+        {WORK_BINARY_TABLE,  "二进制 查表"},
+        {WORK_PRINT_COMPARE, "可打印 比较"},
+        {WORK_PRINT_TABLE,   "可打印 查表"},
+        {WORK_CTYPE,         "分类 ctype x6"},
+        {WORK_CLASS_TABLE,   "分类 查表"},
+    };
+    const size_t size = 4 * 1024 * 1024;
+    
+    unsigned char* data = malloc(size);
+    if (!data) {
+        printf("内存分配失败\n");
+        return;
+    }
+    uint64_t seed = 0xD1B54A32D192ED03ULL;
+    for (size_t i = 0; i < size; i++) {
+        data[i] = (unsigned char)(xorshift64(&seed) >> 56);
+    }
+    
+    // L1数据缓存读缺失
+    int miss_fd = -1;
+#ifdef __linux__
+    miss_fd = perf_counter_open(PERF_TYPE_HW_CACHE,
+        PERF_COUNT_HW_CACHE_L1D |
+        (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+        (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+#endif
+    
+    printf("查找表大小: 十六进制%zu + 二进制%zu + 分类%zu 字节\n",
+           sizeof(hex_pair_table), sizeof(binary_table), sizeof(char_class_table));
+    printf("输入: %zu字节随机数据\n\n", size);
+    printf("%-20s %10s %16s\n", "处理方式", "ns/字节", "L1D缺失/千字节");
+    
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        run_table_workload(cases[c].work, data, 64 * 1024);   // 预热
+        
+        perf_counter_start(miss_fd);
+        clock_t start = clock();
+        run_table_workload(cases[c].work, data, size);
+        clock_t end = clock();
+        uint64_t misses = perf_counter_stop(miss_fd);
+        
+        double ns = ((double)(end - start)) / CLOCKS_PER_SEC * 1e9 / size;
+        if (miss_fd >= 0) {
+            printf("%-20s %10.3f %16.2f\n", cases[c].name, ns,
+                   misses * 1024.0 / size);
+        } else {
+            printf("%-20s %10.3f %16s\n", cases[c].name, ns, "-");
+        }
+    }
+    
+    if (miss_fd >= 0) {
+        printf("\n查表行的缺失数接近基线即表示查找表常驻L1缓存\n");
+        close(miss_fd);
+    } else {
+        printf("\n硬件计数器不可用，跳过缓存驻留检查\n");
+    }
+    free(data);
+}
+
+/*
+ * ========================================
+ * 16. 低开销追踪 (TRACE / DEBUG_PRINT)
+ * ========================================
+ *
+ * 每个线程第一次记录事件时分配一个固定大小的环形缓冲区，
+ * 之后每个事件只是：读时间戳 + 写48字节 + 递增下标，不加锁也
+ * 不做格式化。缓冲区写满后覆盖最旧的事件（飞行记录仪）。
+ * 程序退出时trace_dump()按时间戳合并所有线程的事件并解码成文本。
+ */
+#ifdef ENABLE_TRACE
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>  // __rdtsc
+#define trace_timestamp() __rdtsc()
+#else
+#define trace_timestamp() monotonic_ns()
+#endif
+
+#if defined(_MSC_VER)
+#define TRACE_THREAD_LOCAL __declspec(thread)
+#else
+#define TRACE_THREAD_LOCAL __thread
+#endif
+
+#define TRACE_BUFFER_EVENTS (1 << 16)   // 每线程事件数，必须是2的幂
+
+struct trace_event {
+    uint64_t timestamp;
+    const struct trace_site* site;
+    uint64_t args[4];
+};
+
+struct trace_buffer {
+    uint64_t head;                      // 已记录的事件总数
+    int thread_index;
+    struct trace_buffer* next;          // 所有线程的缓冲区链表
+    struct trace_event events[TRACE_BUFFER_EVENTS];
+};
+
+static TRACE_THREAD_LOCAL struct trace_buffer* trace_local;
+static struct trace_buffer* trace_buffers;
+static int trace_thread_count;
+static uint64_t trace_start_ticks;      // 第一次注册时的时间戳，用于换算
+static uint64_t trace_start_ns;
+#ifdef HAVE_PTHREAD
+static pthread_mutex_t trace_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+void trace_dump(FILE* out);
+
+static void trace_dump_at_exit() {
+    trace_dump(stderr);
+}
+
+// 慢路径：为当前线程分配缓冲区并加入全局链表
+static struct trace_buffer* trace_register_thread() {
+    struct trace_buffer* buf = calloc(1, sizeof(struct trace_buffer));
+    if (!buf) {
+        return NULL;
+    }
+#ifdef HAVE_PTHREAD
+    pthread_mutex_lock(&trace_lock);
+#endif
+    if (!trace_buffers) {
+        trace_start_ticks = trace_timestamp();
+        trace_start_ns = monotonic_ns();
+        atexit(trace_dump_at_exit);
+    }
+    buf->thread_index = trace_thread_count++;
+    buf->next = trace_buffers;
+    trace_buffers = buf;
+#ifdef HAVE_PTHREAD
+    pthread_mutex_unlock(&trace_lock);
+#endif
+    trace_local = buf;
+    return buf;
+}
+
+void trace_record(const struct trace_site* site,
+                  uint64_t a0, uint64_t a1, uint64_t a2, uint64_t a3) {
+    struct trace_buffer* buf = trace_local;
+    if (!buf && !(buf = trace_register_thread())) {
+        return;
+    }
+    struct trace_event* e = &buf->events[buf->head & (TRACE_BUFFER_EVENTS - 1)];
+    e->timestamp = trace_timestamp();
+    e->site = site;
+    e->args[0] = a0;
+    e->args[1] = a1;
+    e->args[2] = a2;
+    e->args[3] = a3;
+    buf->head++;
+}
+
+// 丢弃已记录的事件（所有线程都应已停止记录）
+void trace_reset() {
+    for (struct trace_buffer* b = trace_buffers; b; b = b->next) {
+        b->head = 0;
+    }
+}
+
+// 把一个参数按原始大小截断或符号扩展
+static uint64_t trace_normalize(uint64_t v, unsigned size, bool is_signed) {
+    if (size == 0 || size >= 8) {
+        return v;
+    }
+    unsigned bits = size * 8;
+    v &= (1ULL << bits) - 1;
+    if (is_signed && (v >> (bits - 1))) {
+        v |= ~0ULL << bits;
+    }
+    return v;
+}
+
+// 按调用点的格式串解码一个事件，输出与原DEBUG_PRINT相同的文本
+static void trace_format_event(FILE* out, const struct trace_event* e) {
+    const struct trace_site* site = e->site;
+    const char* p = site->fmt;
+    int arg = 0;
+    
+    fprintf(out, "[DEBUG] %s:%d ", site->file, site->line);
+    
+    while (*p) {
+        if (*p != '%') {
+            fputc(*p++, out);
+            continue;
+        }
+        if (p[1] == '%') {
+            fputc('%', out);
+            p += 2;
+            continue;
+        }
+        
+        // 复制标志、宽度和精度，去掉长度修饰符，整数统一按ll输出
+        char spec[32] = "%";
+        size_t n = 1;
+        p++;
+        while (*p && strchr("-+ #0123456789.", *p) && n < sizeof(spec) - 4) {
+            spec[n++] = *p++;
+        }
+        while (*p && strchr("hljztL", *p)) {
+            p++;
+        }
+        char conv = *p ? *p++ : 'd';
+        uint64_t v = (arg < 4) ? e->args[arg] : 0;
+        unsigned size = (arg < 4) ? site->arg_size[arg] : 0;
+        bool is_double = arg < 4 && (site->arg_double >> arg) & 1;
+        arg++;
+        
+        // 浮点参数只能配浮点格式，反之亦然（原来的printf在这种情况下是未定义行为）
+        if (is_double != (strchr("fFeEgGaA", conv) != NULL)) {
+            fprintf(out, "<参数类型与%%%c不匹配>", conv);
+            continue;
+        }
+        
+        switch (conv) {
+            case 'd': case 'i':
+                memcpy(spec + n, "ll", 2);
+                spec[n + 2] = conv;
+                spec[n + 3] = '\0';
+                fprintf(out, spec, (long long)trace_normalize(v, size, true));
+                break;
+            case 'u': case 'o': case 'x': case 'X':
+                memcpy(spec + n, "ll", 2);
+                spec[n + 2] = conv;
+                spec[n + 3] = '\0';
+                fprintf(out, spec, (unsigned long long)trace_normalize(v, size, false));
+                break;
+            case 'c':
+                spec[n] = 'c';
+                spec[n + 1] = '\0';
+                fprintf(out, spec, (int)trace_normalize(v, size, true));
+                break;
+            case 'p':
+                spec[n] = 'p';
+                spec[n + 1] = '\0';
+                fprintf(out, spec, (void*)(uintptr_t)v);
+                break;
+            case 's':
+                spec[n] = 's';
+                spec[n + 1] = '\0';
+                fprintf(out, spec, v ? (const char*)(uintptr_t)v : "(null)");
+                break;
+            case 'f': case 'F': case 'e': case 'E':
+            case 'g': case 'G': case 'a': case 'A': {
+                double d;
+                memcpy(&d, &v, sizeof(d));
+                spec[n] = conv;
+                spec[n + 1] = '\0';
+                fprintf(out, spec, d);
+                break;
+            }
+            default:
+                fprintf(out, "<不支持的%%%c>", conv);
+                break;
+        }
+    }
+    fputc('\n', out);
+}
+
+// 合并所有线程的事件，按时间先后解码输出
+void trace_dump(FILE* out) {
+    int count = 0;
+    for (struct trace_buffer* b = trace_buffers; b; b = b->next) {
+        count++;
+    }
+    if (count == 0) {
+        return;
+    }
+    
+    struct trace_buffer** bufs = malloc((size_t)count * sizeof(*bufs));
+    uint64_t* pos = malloc((size_t)count * sizeof(*pos));
+    if (!bufs || !pos) {
+        fprintf(out, "追踪记录: 内存分配失败，无法输出%d个线程的事件\n", count);
+        free(bufs);
+        free(pos);
+        return;
+    }
+    
+    int i = 0;
+    for (struct trace_buffer* b = trace_buffers; b; b = b->next, i++) {
+        bufs[i] = b;
+        pos[i] = (b->head > TRACE_BUFFER_EVENTS) ? b->head - TRACE_BUFFER_EVENTS : 0;
+    }
+    uint64_t total = 0;
+    for (i = 0; i < count; i++) {
+        total += bufs[i]->head - pos[i];
+    }
+    if (total == 0) {
+        free(bufs);
+        free(pos);
+        return;
+    }
+    
+    // 用第一次注册以来的时钟走时估算每纳秒的tick数
+    double ticks_per_ns = 1.0;
+    uint64_t elapsed_ns = monotonic_ns() - trace_start_ns;
+    if (elapsed_ns > 0) {
+        ticks_per_ns = (double)(trace_timestamp() - trace_start_ticks) / elapsed_ns;
+    }
+    if (ticks_per_ns <= 0) {
+        ticks_per_ns = 1.0;
+    }
+    
+    fprintf(out, "=== 追踪记录 (%d个线程, %" PRIu64 "个事件) ===\n", count, total);
+    for (;;) {
+        int best = -1;
+        for (int i = 0; i < count; i++) {
+            if (pos[i] < bufs[i]->head &&
+                (best < 0 || bufs[i]->events[pos[i] & (TRACE_BUFFER_EVENTS - 1)].timestamp <
+                             bufs[best]->events[pos[best] & (TRACE_BUFFER_EVENTS - 1)].timestamp)) {
+                best = i;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        const struct trace_event* e =
+            &bufs[best]->events[pos[best]++ & (TRACE_BUFFER_EVENTS - 1)];
+        fprintf(out, "[%12.3fus T%d] ",
+                (double)(int64_t)(e->timestamp - trace_start_ticks) / ticks_per_ns / 1e3,
+                bufs[best]->thread_index);
+        trace_format_event(out, e);
+    }
+    free(bufs);
+    free(pos);
+}
+
+#endif /* ENABLE_TRACE */
+
+// 每个事件的开销：TRACE与原来printf风格的DEBUG_PRINT对比
+void trace_benchmark() {
+    PROFILE_FUNCTION();
+    SECTION_HEADER("追踪开销测试");
+    
+#ifdef ENABLE_TRACE
+    const int events = 10000000;
+    
+    uint64_t start = monotonic_ns();
+    for (int i = 0; i < events; i++) {
+        TRACE("i=%d x=%#x", i, i * 3);
+    }
+    uint64_t end = monotonic_ns();
+    printf("TRACE (2个参数) %d次: %.1f ns/事件\n", events,
+           (double)(end - start) / events);
+    
+    FILE* devnull = fopen("/dev/null", "w");
+    if (devnull) {
+        const int print_events = 1000000;
+        start = monotonic_ns();
+        for (int i = 0; i < print_events; i++) {
+            fprintf(devnull, "[DEBUG] %s:%d i=%d x=%#x\n", __FILE__, __LINE__, i, i * 3);
+        }
+        end = monotonic_ns();
+        printf("fprintf到/dev/null %d次: %.1f ns/事件\n", print_events,
+               (double)(end - start) / print_events);
+        fclose(devnull);
+    }
+    
+    trace_reset();              // 不把测试事件留到退出时的转储中
+#else
+    printf("未定义ENABLE_TRACE：TRACE和DEBUG_PRINT在编译时被完全移除，开销为0\n");
+    printf("使用 -DENABLE_TRACE 重新编译后运行 --trace-bench\n");
+#endif
+}
+
+/*
+ * ========================================
+ * 17. 分段性能剖析 (PROFILE_FUNCTION)
+ * ========================================
+ *
+ * 每个线程维护自己的作用域栈和调用树，不需要加锁：
+ *   - 进入作用域：在父节点的子节点中查找（或新建）同名节点并压栈
+ *   - 离开作用域：累加调用次数、包含时间和独占时间
+ *     （独占时间 = 包含时间 - 直接子作用域的时间）
+ * 每次调用同时记录一个完整事件，用于导出Chrome trace。
+ * 程序退出时输出汇总表，并写出:
+ *   profile.folded  折叠栈，可用flamegraph.pl或speedscope打开
+ *   profile.json    Chrome trace，可用chrome://tracing或Perfetto打开
+ */
+#if defined(ENABLE_PROFILE) && defined(__GNUC__)
+
+#define PROFILE_MAX_DEPTH  64
+#define PROFILE_MAX_NODES  1024             // 每线程调用树节点数
+#define PROFILE_MAX_EVENTS (1 << 16)        // 每线程记录的完整事件数
+
+struct profile_node {
+    const char* name;
+    int parent;                 // 下标，nodes[0]为根节点
+    int first_child;
+    int next_sibling;
+    uint64_t calls;
+    uint64_t inclusive_ns;
+    uint64_t exclusive_ns;
+};
+
+struct profile_frame {
+    int node;
+    uint64_t start_ns;
+    uint64_t child_ns;          // 直接子作用域的累计时间
+};
+
+struct profile_event {
+    const char* name;
+    uint64_t start_ns;
+    uint64_t duration_ns;
+};
+
+struct profile_thread {
+    int thread_index;
+    struct profile_thread* next;
+    int depth;
+    int node_count;
+    uint64_t event_count;
+    uint64_t overflow;          // 栈过深或节点/事件表满而未记录的次数
+    struct profile_frame stack[PROFILE_MAX_DEPTH];
+    struct profile_node nodes[PROFILE_MAX_NODES];
+    struct profile_event events[PROFILE_MAX_EVENTS];
+};
+
+static __thread struct profile_thread* profile_local;
+static struct profile_thread* profile_threads;
+static int profile_thread_count;
+static uint64_t profile_start_ns;
+#ifdef HAVE_PTHREAD
+static pthread_mutex_t profile_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static struct profile_thread* profile_register_thread() {
+    struct profile_thread* t = calloc(1, sizeof(struct profile_thread));
+    if (!t) {
+        return NULL;
+    }
+    t->nodes[0].name = "root";
+    t->nodes[0].parent = -1;
+    t->nodes[0].first_child = -1;
+    t->nodes[0].next_sibling = -1;
+    t->node_count = 1;
+    
+#ifdef HAVE_PTHREAD
+    pthread_mutex_lock(&profile_lock);
+#endif
+    t->thread_index = profile_thread_count++;
+    t->next = profile_threads;
+    profile_threads = t;
+#ifdef HAVE_PTHREAD
+    pthread_mutex_unlock(&profile_lock);
+#endif
+    profile_local = t;
+    return t;
+}
+
+// 在parent的子节点中查找name，没有则新建；节点表满时返回-1
+static int profile_child(struct profile_thread* t, int parent, const char* name) {
+    for (int c = t->nodes[parent].first_child; c >= 0; c = t->nodes[c].next_sibling) {
+        if (t->nodes[c].name == name || strcmp(t->nodes[c].name, name) == 0) {
+            return c;
+        }
+    }
+    if (t->node_count >= PROFILE_MAX_NODES) {
+        return -1;
+    }
+    int c = t->node_count++;
+    t->nodes[c].name = name;
+    t->nodes[c].parent = parent;
+    t->nodes[c].first_child = -1;
+    t->nodes[c].next_sibling = t->nodes[parent].first_child;
+    t->nodes[parent].first_child = c;
+    return c;
+}
+
+struct profile_scope profile_begin(const char* name) {
+    struct profile_scope scope = {false};
+    struct profile_thread* t = profile_local;
+    
+    if (!t && !(t = profile_register_thread())) {
+        return scope;
+    }
+    if (t->depth >= PROFILE_MAX_DEPTH) {
+        t->overflow++;
+        return scope;
+    }
+    int parent = t->depth ? t->stack[t->depth - 1].node : 0;
+    int node = profile_child(t, parent, name);
+    if (node < 0) {
+        t->overflow++;
+        return scope;
+    }
+    
+    struct profile_frame* f = &t->stack[t->depth++];
+    f->node = node;
+    f->child_ns = 0;
+    f->start_ns = monotonic_ns();
+    scope.active = true;
+    return scope;
+}
+
+void profile_pop() {
+    uint64_t now = monotonic_ns();
+    struct profile_thread* t = profile_local;
+    struct profile_frame* f = &t->stack[--t->depth];
+    struct profile_node* n = &t->nodes[f->node];
+    uint64_t duration = now - f->start_ns;
+    
+    n->calls++;
+    n->inclusive_ns += duration;
+    n->exclusive_ns += duration - f->child_ns;
+    if (t->depth > 0) {
+        t->stack[t->depth - 1].child_ns += duration;
+    }
+    
+    if (t->event_count < PROFILE_MAX_EVENTS) {
+        struct profile_event* e = &t->events[t->event_count++];
+        e->name = n->name;
+        e->start_ns = f->start_ns;
+        e->duration_ns = duration;
+    } else {
+        t->overflow++;
+    }
+}
+
+// 节点的祖先中是否有同名节点（递归调用只统计最外层的包含时间）
+static bool profile_has_ancestor(const struct profile_thread* t, int node) {
+    const char* name = t->nodes[node].name;
+    for (int p = t->nodes[node].parent; p > 0; p = t->nodes[p].parent) {
+        if (strcmp(t->nodes[p].name, name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+struct profile_summary {
+    const char* name;
+    uint64_t calls;
+    uint64_t inclusive_ns;
+    uint64_t exclusive_ns;
+};
+
+static int compare_summary(const void* a, const void* b) {
+    const struct profile_summary* x = (const struct profile_summary*)a;
+    const struct profile_summary* y = (const struct profile_summary*)b;
+    return (x->exclusive_ns < y->exclusive_ns) - (x->exclusive_ns > y->exclusive_ns);
+}
+
+// 按函数名合并所有线程的调用树节点，按独占时间排序输出
+static void profile_print_summary(FILE* out) {
+    static struct profile_summary rows[PROFILE_MAX_NODES];
+    int count = 0;
+    uint64_t total_ns = 0;
+    uint64_t overflow = 0;
+    
+    for (struct profile_thread* t = profile_threads; t; t = t->next) {
+        overflow += t->overflow;
+        for (int i = 1; i < t->node_count; i++) {
+            const struct profile_node* n = &t->nodes[i];
+            int r = 0;
+            while (r < count && strcmp(rows[r].name, n->name) != 0) {
+                r++;
+            }
+            if (r == count) {
+                if (count == PROFILE_MAX_NODES) {
+                    continue;
+                }
+                rows[count].name = n->name;
+                rows[count].calls = 0;
+                rows[count].inclusive_ns = 0;
+                rows[count].exclusive_ns = 0;
+                count++;
+            }
+            rows[r].calls += n->calls;
+            rows[r].exclusive_ns += n->exclusive_ns;
+            if (!profile_has_ancestor(t, i)) {
+                rows[r].inclusive_ns += n->inclusive_ns;
+            }
+            total_ns += n->exclusive_ns;
+        }
+    }
+    
+    qsort(rows, (size_t)count, sizeof(rows[0]), compare_summary);
+    
+    fprintf(out, "\n=== 分段性能剖析 ===\n");
+    fprintf(out, "%-32s %8s %12s %12s %7s\n", "作用域", "调用次数", "包含(ms)", "独占(ms)", "独占%");
+    for (int r = 0; r < count; r++) {
+        fprintf(out, "%-32s %8" PRIu64 " %12.3f %12.3f %6.1f%%\n",
+                rows[r].name, rows[r].calls, rows[r].inclusive_ns / 1e6,
+                rows[r].exclusive_ns / 1e6,
+                total_ns ? 100.0 * rows[r].exclusive_ns / total_ns : 0.0);
+    }
+    if (overflow) {
+        fprintf(out, "（%" PRIu64 "次作用域因表满或栈过深未记录）\n", overflow);
+    }
+}
+
+// 折叠栈格式：每行 "main;父;子 独占微秒数"
+static void profile_write_folded(FILE* out) {
+    int path[PROFILE_MAX_DEPTH];
+    
+    for (struct profile_thread* t = profile_threads; t; t = t->next) {
+        for (int i = 1; i < t->node_count; i++) {
+            uint64_t us = t->nodes[i].exclusive_ns / 1000;
+            if (us == 0) {
+                continue;
+            }
+            int depth = 0;
+            for (int p = i; p > 0 && depth < PROFILE_MAX_DEPTH; p = t->nodes[p].parent) {
+                path[depth++] = p;
+            }
+            while (depth-- > 0) {
+                fprintf(out, "%s%c", t->nodes[path[depth]].name, depth ? ';' : ' ');
+            }
+            fprintf(out, "%" PRIu64 "\n", us);
+        }
+    }
+}
+
+static void json_write_string(FILE* out, const char* s) {
+    fputc('"', out);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') {
+            fputc('\\', out);
+        }
+        if ((unsigned char)*s < 0x20) {
+            fprintf(out, "\\u%04x", *s);
+        } else {
+            fputc(*s, out);
+        }
+    }
+    fputc('"', out);
+}
+
+// Chrome trace事件格式，ph为"X"的完整事件，时间单位微秒
+static void profile_write_chrome_trace(FILE* out) {
+    bool first = true;
+    
+    fprintf(out, "{\"traceEvents\":[\n");
+    for (struct profile_thread* t = profile_threads; t; t = t->next) {
+        for (uint64_t i = 0; i < t->event_count; i++) {
+            const struct profile_event* e = &t->events[i];
+            fprintf(out, "%s{\"name\":", first ? "" : ",\n");
+            json_write_string(out, e->name);
+            fprintf(out, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+                    (e->start_ns - profile_start_ns) / 1e3, e->duration_ns / 1e3,
+                    t->thread_index);
+            first = false;
+        }
+    }
+    fprintf(out, "\n],\"displayTimeUnit\":\"ms\"}\n");
+}
+
+// 打开文件并调用emit写出，逐个报告成功或失败
+static void profile_write_file(const char* path, const char* kind,
+                               void (*emit)(FILE* out)) {
+    FILE* fp = fopen(path, "w");
+    if (!fp) {
+        fprintf(stderr, "无法写出 %s: %s\n", path, strerror(errno));
+        return;
+    }
+    emit(fp);
+    bool failed = ferror(fp) != 0;
+    if (fclose(fp) != 0 || failed) {
+        fprintf(stderr, "写入 %s 失败\n", path);
+        return;
+    }
+    fprintf(stderr, "已写出 %s (%s)\n", path, kind);
+}
+
+static void profile_write_reports() {
+    profile_print_summary(stderr);
+    profile_write_file("profile.folded", "火焰图", profile_write_folded);
+    profile_write_file("profile.json", "Chrome trace", profile_write_chrome_trace);
+}
+
+// 打开剖析，退出时（main的作用域结束后）输出报告
+void profile_start() {
+    profile_start_ns = monotonic_ns();
+    profile_enabled = true;
+    atexit(profile_write_reports);
+}
+
+#endif /* ENABLE_PROFILE */
+
+/*
+ * ========================================
+ * 18. 浮点精度穷举测试 (float32全部位模式)
+ * ========================================
+ *
+ * 第2节只检查了几个手选的数值。float只有2^32种位模式，
+ * 完全可以逐个检查：
+ *   - 分类统计：零、次正规数、正规数、无穷、安静/信号NaN
+ *   - float -> double -> float 往返是否保持位模式不变
+ *   - sqrtf(x)、1.0f/x、x+0.1f 的ULP误差直方图
+ *     sqrtf和1/x与double结果比较；x+0.1f在两个指数相差很大时
+ *     double也装不下精确和，因此用TwoSum求出加法的精确舍入误差
+ *     （操作数都是float，测到的是运算本身的误差，而不是0.1f与0.1的差）
+ * 计算部分用SSE2每次处理4个值，范围按块分给所有CPU核心。
+ *
+ * 用法: basic_types --float-sweep [起始位模式 结束位模式]
+ */
+
+enum float_class {
+    FLOAT_ZERO,
+    FLOAT_SUBNORMAL,
+    FLOAT_NORMAL,
+    FLOAT_INFINITE,
+    FLOAT_QUIET_NAN,
+    FLOAT_SIGNALING_NAN,
+    FLOAT_CLASS_COUNT
+};
+
+static const char* const float_class_names[FLOAT_CLASS_COUNT] = {
+    "零", "次正规数", "正规数", "无穷", "安静NaN", "信号NaN"
+};
+
+enum float_op { OP_SQRT, OP_RECIP, OP_ADD_TENTH, FLOAT_OP_COUNT };
+
+static const char* const float_op_names[FLOAT_OP_COUNT] = {
+    "sqrtf(x)", "1.0f/x", "x+0.1f"
+};
+
+static const char* const float_op_references[FLOAT_OP_COUNT] = {
+    "double", "double", "TwoSum精确误差"
+};
+
+/*
+ * ULP误差直方图：
+ *   0              精确
+ *   1              (0, 0.5]，即正确舍入
+ *   2 .. 22        (2^(k-3), 2^(k-2)]，即 (0.5,1], (1,2], ... (2^19,2^20]
+ *   ULP_BUCKET_HUGE   > 2^20 ULP
+ *   ULP_BUCKET_NAN    结果和参考值都是NaN（无定义的运算）
+ *   ULP_BUCKET_WRONG  其中一个是NaN/无穷而另一个不是
+ */
+#define ULP_BUCKET_HUGE  23
+#define ULP_BUCKET_NAN   24
+#define ULP_BUCKET_WRONG 25
+#define ULP_BUCKETS      26
+
+#define FLOAT_SWEEP_BLOCK 256               // 每次SIMD计算的位模式数
+#define FLOAT_SWEEP_CHUNK (1U << 20)        // 每个线程每次领取的位模式数
+
+struct float_sweep_stats {
+    uint64_t classes[FLOAT_CLASS_COUNT];
+    uint64_t roundtrip_changed;
+    uint32_t roundtrip_example;
+    uint64_t hist[FLOAT_OP_COUNT][ULP_BUCKETS];
+    double max_ulp[FLOAT_OP_COUNT];
+    uint32_t max_ulp_bits[FLOAT_OP_COUNT];
+};
+
+static inline float float_from_bits(uint32_t b) {
+    float f;
+    memcpy(&f, &b, sizeof(f));
+    return f;
+}
+
+static inline uint32_t float_to_bits(float f) {
+    uint32_t b;
+    memcpy(&b, &f, sizeof(b));
+    return b;
+}
+
+static inline enum float_class classify_float_bits(uint32_t b) {
+    uint32_t exponent = (b >> 23) & 0xFF;
+    uint32_t mantissa = b & 0x7FFFFF;
+    
+    if (exponent == 0) {
+        return mantissa ? FLOAT_SUBNORMAL : FLOAT_ZERO;
+    }
+    if (exponent == 0xFF) {
+        if (mantissa == 0) {
+            return FLOAT_INFINITE;
+        }
+        return (mantissa & 0x400000) ? FLOAT_QUIET_NAN : FLOAT_SIGNALING_NAN;
+    }
+    return FLOAT_NORMAL;
+}
+
+// float结果r处一个ULP的大小（以double表示，直接构造指数位）
+static inline double float_ulp(uint32_t r_bits) {
+    uint64_t exponent = (r_bits >> 23) & 0xFF;
+    uint64_t d_bits = ((exponent ? exponent : 1) - 150 + 1023) << 52;
+    double ulp;
+    memcpy(&ulp, &d_bits, sizeof(ulp));
+    return ulp;
+}
+
+// 一个块内三种运算的float结果、double参考值和ULP误差
+struct float_sweep_block {
+    float result[FLOAT_OP_COUNT][FLOAT_SWEEP_BLOCK];
+    double reference[FLOAT_OP_COUNT][FLOAT_SWEEP_BLOCK];
+    double error[FLOAT_OP_COUNT][FLOAT_SWEEP_BLOCK];
+    uint32_t roundtrip[FLOAT_SWEEP_BLOCK];
+};
+
+#if defined(__SSE2__)
+#include <emmintrin.h>  // SSE2
+
+// 由4个float结果的位模式构造对应的4个ULP（两个__m128d）
+static inline void ulp_pd(__m128 r, __m128d* lo, __m128d* hi) {
+    __m128i exponent = _mm_and_si128(_mm_srli_epi32(_mm_castps_si128(r), 23),
+                                     _mm_set1_epi32(0xFF));
+    // 指数为0（次正规数）时按1处理
+    __m128i is_zero = _mm_cmpeq_epi32(exponent, _mm_setzero_si128());
+    exponent = _mm_or_si128(exponent, _mm_and_si128(is_zero, _mm_set1_epi32(1)));
+    exponent = _mm_add_epi32(exponent, _mm_set1_epi32(1023 - 150));
+    // 扩展为64位后移到double的指数位置
+    __m128i e_lo = _mm_unpacklo_epi32(exponent, _mm_setzero_si128());
+    __m128i e_hi = _mm_unpackhi_epi32(exponent, _mm_setzero_si128());
+    *lo = _mm_castsi128_pd(_mm_slli_epi64(e_lo, 52));
+    *hi = _mm_castsi128_pd(_mm_slli_epi64(e_hi, 52));
+}
+
+// diff为结果与精确值之差，误差 = |diff| / ulp(r)
+static inline void store_op_diff(struct float_sweep_block* blk, int op, uint32_t i,
+                                 __m128 r, __m128d ref_lo, __m128d ref_hi,
+                                 __m128d diff_lo, __m128d diff_hi) {
+    const __m128d abs_mask = _mm_castsi128_pd(_mm_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+    __m128d ulp_lo, ulp_hi;
+    ulp_pd(r, &ulp_lo, &ulp_hi);
+    
+    __m128d err_lo = _mm_div_pd(_mm_and_pd(diff_lo, abs_mask), ulp_lo);
+    __m128d err_hi = _mm_div_pd(_mm_and_pd(diff_hi, abs_mask), ulp_hi);
+    
+    _mm_storeu_ps(&blk->result[op][i], r);
+    _mm_storeu_pd(&blk->reference[op][i], ref_lo);
+    _mm_storeu_pd(&blk->reference[op][i + 2], ref_hi);
+    _mm_storeu_pd(&blk->error[op][i], err_lo);
+    _mm_storeu_pd(&blk->error[op][i + 2], err_hi);
+}
+
+// double参考值足够精确时，diff直接取 r - ref
+static inline void store_op(struct float_sweep_block* blk, int op, uint32_t i,
+                            __m128 r, __m128d ref_lo, __m128d ref_hi) {
+    __m128d r_lo = _mm_cvtps_pd(r);
+    __m128d r_hi = _mm_cvtps_pd(_mm_movehl_ps(r, r));
+    store_op_diff(blk, op, i, r, ref_lo, ref_hi,
+                  _mm_sub_pd(r_lo, ref_lo), _mm_sub_pd(r_hi, ref_hi));
+}
+
+static void compute_float_block(uint32_t first, struct float_sweep_block* blk) {
+    const __m128i lane = _mm_set_epi32(3, 2, 1, 0);
+    const __m128 one_f = _mm_set1_ps(1.0f);
+    const __m128 tenth_f = _mm_set1_ps(0.1f);
+    const __m128d one_d = _mm_set1_pd(1.0);
+    const __m128d tenth_d = _mm_set1_pd((double)0.1f);
+    
+    for (uint32_t i = 0; i < FLOAT_SWEEP_BLOCK; i += 4) {
+        __m128i bits = _mm_add_epi32(_mm_set1_epi32((int)(first + i)), lane);
+        __m128 x = _mm_castsi128_ps(bits);
+        __m128d x_lo = _mm_cvtps_pd(x);
+        __m128d x_hi = _mm_cvtps_pd(_mm_movehl_ps(x, x));
+        
+        // 往返转换
+        __m128 back = _mm_movelh_ps(_mm_cvtpd_ps(x_lo), _mm_cvtpd_ps(x_hi));
+        _mm_storeu_si128((__m128i*)&blk->roundtrip[i], _mm_castps_si128(back));
+        
+        store_op(blk, OP_SQRT, i, _mm_sqrt_ps(x),
+                 _mm_sqrt_pd(x_lo), _mm_sqrt_pd(x_hi));
+        store_op(blk, OP_RECIP, i, _mm_div_ps(one_f, x),
+                 _mm_div_pd(one_d, x_lo), _mm_div_pd(one_d, x_hi));
+        // TwoSum: s + e == x + 0.1f 精确成立（无溢出时），e即舍入误差
+        __m128 sum = _mm_add_ps(x, tenth_f);
+        __m128 bb = _mm_sub_ps(sum, x);
+        __m128 e = _mm_add_ps(_mm_sub_ps(x, _mm_sub_ps(sum, bb)),
+                              _mm_sub_ps(tenth_f, bb));
+        store_op_diff(blk, OP_ADD_TENTH, i, sum,
+                      _mm_add_pd(x_lo, tenth_d), _mm_add_pd(x_hi, tenth_d),
+                      _mm_cvtps_pd(e), _mm_cvtps_pd(_mm_movehl_ps(e, e)));
+    }
+}
+
+#else
+
+static void compute_float_block(uint32_t first, struct float_sweep_block* blk) {
+    for (uint32_t i = 0; i < FLOAT_SWEEP_BLOCK; i++) {
+        float x = float_from_bits(first + i);
+        volatile double wide = x;           // 阻止编译器把往返转换优化掉
+        blk->roundtrip[i] = float_to_bits((float)wide);
+        
+        blk->result[OP_SQRT][i] = sqrtf(x);
+        blk->reference[OP_SQRT][i] = sqrt((double)x);
+        blk->result[OP_RECIP][i] = 1.0f / x;
+        blk->reference[OP_RECIP][i] = 1.0 / (double)x;
+        blk->result[OP_ADD_TENTH][i] = x + 0.1f;
+        blk->reference[OP_ADD_TENTH][i] = (double)x + (double)0.1f;
+        
+        for (int op = 0; op < OP_ADD_TENTH; op++) {
+            float r = blk->result[op][i];
+            blk->error[op][i] = fabs((double)r - blk->reference[op][i]) /
+                                float_ulp(float_to_bits(r));
+        }
+        
+        // TwoSum: s + e == x + 0.1f 精确成立（无溢出时），e即舍入误差
+        float sum = blk->result[OP_ADD_TENTH][i];
+        float bb = sum - x;
+        float e = (x - (sum - bb)) + (0.1f - bb);
+        blk->error[OP_ADD_TENTH][i] = fabs((double)e) / float_ulp(float_to_bits(sum));
+    }
+}
+
+#endif
+
+// 误差为有限值时的直方图下标：按(2^m, 2^(m+1)]区间划分
+static inline int ulp_bucket(double err) {
+    if (err == 0) {
+        return 0;
+    }
+    uint64_t bits;
+    memcpy(&bits, &err, sizeof(bits));
+    int e = (int)(((bits - 1) >> 52) & 0x7FF) - 1023;   // 减1使2的幂落在下面的区间
+    int bucket = e + 3;                                 // (0.25,0.5] -> 1
+    if (bucket < 1) {
+        bucket = 1;
+    }
+    return bucket > ULP_BUCKET_HUGE ? ULP_BUCKET_HUGE : bucket;
+}
+
+// 单个误差值计入直方图
+static inline void accumulate_float_error(const struct float_sweep_block* blk,
+                                          int op, uint32_t i, uint32_t bits,
+                                          uint64_t* hist, double* max_ulp,
+                                          uint32_t* max_bits) {
+    double err = blk->error[op][i];
+    int bucket;
+    
+    if (isfinite(err)) {
+        bucket = ulp_bucket(err);
+        if (err > *max_ulp) {
+            *max_ulp = err;
+            *max_bits = bits;
+        }
+    } else {
+        // NaN或无穷：结果与参考值（舍入到float后）比较
+        float r = blk->result[op][i];
+        double ref = blk->reference[op][i];
+        if (isnan(r) && isnan(ref)) {
+            bucket = ULP_BUCKET_NAN;
+        } else if (float_to_bits(r) == float_to_bits((float)ref)) {
+            bucket = isinf(ref) ? 0 : 1;    // 精确或正确舍入为无穷
+        } else {
+            bucket = ULP_BUCKET_WRONG;
+        }
+    }
+    hist[bucket]++;
+}
+
+static void accumulate_float_block(uint32_t first, uint32_t count,
+                                   const struct float_sweep_block* blk,
+                                   struct float_sweep_stats* st) {
+    // 分类计数器按i%4分成4组，避免连续自增同一计数器形成的内存依赖
+    uint32_t classes[4][FLOAT_CLASS_COUNT] = {{0}};
+    
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t b = first + i;
+        classes[i & 3][classify_float_bits(b)]++;
+        if (blk->roundtrip[i] != b) {
+            if (st->roundtrip_changed++ == 0) {
+                st->roundtrip_example = b;
+            }
+        }
+    }
+    for (int c = 0; c < FLOAT_CLASS_COUNT; c++) {
+        st->classes[c] += classes[0][c] + classes[1][c] + classes[2][c] + classes[3][c];
+    }
+    
+    for (int op = 0; op < FLOAT_OP_COUNT; op++) {
+        uint64_t* hist = st->hist[op];
+        double max_ulp = st->max_ulp[op];
+        uint32_t max_bits = st->max_ulp_bits[op];
+        uint32_t i = 0;
+        
+#if defined(__SSE2__)
+        // 快速路径：绝大多数结果是正确舍入的，误差在(0, 0.5]内，
+        // 成对比较后只计数；其余情况交给标量路径
+        const __m128d zero = _mm_setzero_pd();
+        const __m128d half = _mm_set1_pd(0.5);
+        __m128d block_max = zero;
+        uint64_t rounded = 0;
+        
+        for (; i + 2 <= count; i += 2) {
+            __m128d e = _mm_loadu_pd(&blk->error[op][i]);
+            __m128d ok = _mm_and_pd(_mm_cmpgt_pd(e, zero), _mm_cmple_pd(e, half));
+            if (_mm_movemask_pd(ok) == 3) {
+                rounded += 2;
+                block_max = _mm_max_pd(block_max, e);
+            } else {
+                accumulate_float_error(blk, op, i, first + i, hist, &max_ulp, &max_bits);
+                accumulate_float_error(blk, op, i + 1, first + i + 1, hist, &max_ulp, &max_bits);
+            }
+        }
+        hist[1] += rounded;
+        
+        double pair[2];
+        _mm_storeu_pd(pair, block_max);
+        if (pair[0] > max_ulp || pair[1] > max_ulp) {
+            // 快速路径中出现了新的最大值，重新找出它的位置
+            for (uint32_t j = 0; j < i; j++) {
+                double err = blk->error[op][j];
+                if (err > max_ulp && err <= 0.5) {
+                    max_ulp = err;
+                    max_bits = first + j;
+                }
+            }
+        }
+#endif
+        for (; i < count; i++) {
+            accumulate_float_error(blk, op, i, first + i, hist, &max_ulp, &max_bits);
+        }
+        
+        st->max_ulp[op] = max_ulp;
+        st->max_ulp_bits[op] = max_bits;
+    }
+}
+
+struct float_sweep_job {
+    uint64_t next;                  // 下一个待领取的位模式（原子递增）
+    uint64_t end;                   // 不含
+    struct float_sweep_stats* stats;
+};
+
+static void float_sweep_range(struct float_sweep_job* job,
+                              struct float_sweep_stats* st) {
+    struct float_sweep_block* blk = malloc(sizeof(*blk));   // 约11KB
+    if (!blk) {
+        return;
+    }
+    
+    for (;;) {
+#ifdef HAVE_PTHREAD
+        uint64_t start = __atomic_fetch_add(&job->next, FLOAT_SWEEP_CHUNK, __ATOMIC_RELAXED);
+#else
+        uint64_t start = job->next;
+        job->next += FLOAT_SWEEP_CHUNK;
+#endif
+        if (start >= job->end) {
+            break;
+        }
+        uint64_t stop = start + FLOAT_SWEEP_CHUNK < job->end ? start + FLOAT_SWEEP_CHUNK : job->end;
+        
+        for (uint64_t b = start; b < stop; b += FLOAT_SWEEP_BLOCK) {
+            uint32_t count = (uint32_t)(stop - b < FLOAT_SWEEP_BLOCK ? stop - b : FLOAT_SWEEP_BLOCK);
+            // 块总是完整计算256个值（位模式在uint32内回绕），只累计前count个
+            compute_float_block((uint32_t)b, blk);
+            accumulate_float_block((uint32_t)b, count, blk, st);
+        }
+    }
+    free(blk);
+}
+
+#ifdef HAVE_PTHREAD
+struct float_sweep_worker {
+    struct float_sweep_job* job;
+    struct float_sweep_stats stats;
+};
+
+static void* float_sweep_worker_main(void* arg) {
+    struct float_sweep_worker* w = (struct float_sweep_worker*)arg;
+    float_sweep_range(w->job, &w->stats);
+    return NULL;
+}
+#endif
+
+static void merge_float_stats(struct float_sweep_stats* dst,
+                              const struct float_sweep_stats* src) {
+    for (int c = 0; c < FLOAT_CLASS_COUNT; c++) {
+        dst->classes[c] += src->classes[c];
+    }
+    if (src->roundtrip_changed && !dst->roundtrip_changed) {
+        dst->roundtrip_example = src->roundtrip_example;
+    }
+    dst->roundtrip_changed += src->roundtrip_changed;
+    for (int op = 0; op < FLOAT_OP_COUNT; op++) {
+        for (int k = 0; k < ULP_BUCKETS; k++) {
+            dst->hist[op][k] += src->hist[op][k];
+        }
+        if (src->max_ulp[op] > dst->max_ulp[op]) {
+            dst->max_ulp[op] = src->max_ulp[op];
+            dst->max_ulp_bits[op] = src->max_ulp_bits[op];
+        }
+    }
+}
+
+static void format_ulp_bucket(char* buf, size_t size, int k) {
+    if (k == 0) {
+        snprintf(buf, size, "0 (精确)");
+    } else if (k == 1) {
+        snprintf(buf, size, "(0, 0.5]");
+    } else if (k < ULP_BUCKET_HUGE) {
+        snprintf(buf, size, "(%.6g, %.0f]", ldexp(1.0, k - 3), ldexp(1.0, k - 2));
+    } else if (k == ULP_BUCKET_HUGE) {
+        snprintf(buf, size, "> 2^20");
+    } else if (k == ULP_BUCKET_NAN) {
+        snprintf(buf, size, "NaN (无定义)");
+    } else {
+        snprintf(buf, size, "不一致");
+    }
+}
+
+static void print_float_sweep_report(const struct float_sweep_stats* st,
+                                     uint64_t total) {
+    printf("=== 分类统计 ===\n");
+    for (int c = 0; c < FLOAT_CLASS_COUNT; c++) {
+        printf("%-12s %12" PRIu64 " (%6.3f%%)\n", float_class_names[c],
+               st->classes[c], 100.0 * st->classes[c] / total);
+    }
+    
+    printf("\n=== float -> double -> float 往返 ===\n");
+    if (st->roundtrip_changed) {
+        float x = float_from_bits(st->roundtrip_example);
+        volatile double wide = x;
+        printf("位模式改变: %" PRIu64 "个，例如 0x%08" PRIx32 " -> 0x%08" PRIx32
+               "（信号NaN被转换为安静NaN）\n", st->roundtrip_changed,
+               st->roundtrip_example, float_to_bits((float)wide));
+    } else {
+        printf("全部%" PRIu64 "个位模式往返后保持不变\n", total);
+    }
+    
+    for (int op = 0; op < FLOAT_OP_COUNT; op++) {
+        printf("\n=== %s 的ULP误差 (参考值: %s) ===\n", float_op_names[op],
+               float_op_references[op]);
+        for (int k = 0; k < ULP_BUCKETS; k++) {
+            if (st->hist[op][k] == 0) {
+                continue;
+            }
+            char label[32];
+            format_ulp_bucket(label, sizeof(label), k);
+            double pct = 100.0 * st->hist[op][k] / total;
+            int bar = (int)(pct / 2 + 0.5);
+            printf("%-16s %12" PRIu64 " %7.3f%% ", label, st->hist[op][k], pct);
+            for (int j = 0; j < bar; j++) {
+                putchar('#');
+            }
+            putchar('\n');
+        }
+        if (st->max_ulp[op] > 0) {
+            printf("最大误差: %.6g ULP, x = %.9g (0x%08" PRIx32 ")\n", st->max_ulp[op],
+                   float_from_bits(st->max_ulp_bits[op]), st->max_ulp_bits[op]);
+        } else {
+            printf("最大误差: 0 ULP（没有非零的有限误差）\n");
+        }
+    }
+}
+
+// 解析命令行中的位模式（十进制、0x十六进制或0八进制），拒绝负数和多余字符
+static bool parse_float_bits(const char* text, uint32_t* out) {
+    char* end;
+    
+    if (*text == '-' || *text == '+') {
+        return false;
+    }
+    errno = 0;
+    unsigned long long value = strtoull(text, &end, 0);
+    if (end == text || *end != '\0' || errno == ERANGE || value > UINT32_MAX) {
+        return false;
+    }
+    *out = (uint32_t)value;
+    return true;
+}
+
+// 扫描[first, last]范围内的位模式（包含两端）
+void float_precision_sweep(uint32_t first, uint32_t last) {
+    PROFILE_FUNCTION();
+    SECTION_HEADER("18. float32精度穷举测试");
+    
+    static struct float_sweep_stats total_stats;
+    struct float_sweep_job job = {first, (uint64_t)last + 1, &total_stats};
+    uint64_t total = job.end - job.next;
+    int threads = 1;
+    
+    memset(&total_stats, 0, sizeof(total_stats));
+    uint64_t start = monotonic_ns();
+    
+#ifdef HAVE_PTHREAD
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = (cpus > 1) ? (int)(cpus < 64 ? cpus : 64) : 1;
+    
+    struct float_sweep_worker* workers = calloc((size_t)threads, sizeof(*workers));
+    pthread_t* ids = calloc((size_t)threads, sizeof(*ids));
+    if (!workers || !ids) {
+        printf("内存分配失败\n");
+        free(workers);
+        free(ids);
+        return;
+    }
+    int created = 0;
+    while (created < threads) {
+        workers[created].job = &job;
+        if (pthread_create(&ids[created], NULL, float_sweep_worker_main,
+                           &workers[created]) != 0) {
+            break;
+        }
+        created++;
+    }
+    if (created == 0) {         // 无法创建线程时在当前线程完成
+        float_sweep_range(&job, &total_stats);
+        created = 1;
+    } else {
+        for (int t = 0; t < created; t++) {
+            pthread_join(ids[t], NULL);
+            merge_float_stats(&total_stats, &workers[t].stats);
+        }
+    }
+    threads = created;
+    free(workers);
+    free(ids);
+#else
+    float_sweep_range(&job, &total_stats);
+#endif
+    
+    double seconds = (monotonic_ns() - start) / 1e9;
+    
+    printf("范围: 0x%08" PRIx32 " ~ 0x%08" PRIx32 " (%" PRIu64 "个位模式)\n",
+           first, last, total);
+#if defined(__SSE2__)
+    printf("计算: SSE2, %d个线程, 用时%.2f秒, %.2f 亿值/秒\n\n",
+           threads, seconds, seconds > 0 ? total / seconds / 1e8 : 0.0);
+#else
+    printf("计算: 标量, %d个线程, 用时%.2f秒, %.2f 亿值/秒\n\n",
+           threads, seconds, seconds > 0 ? total / seconds / 1e8 : 0.0);
+#endif
+    
+    print_float_sweep_report(&total_stats, total);
+}
+
+/*
+ * ========================================
+ * 主函数 - 程序入口点
+ * ========================================
+ */
+// 从参数列表中取出全局选项（可出现在任意位置），找到时返回true
+static bool take_option(int* argc, char* argv[], const char* option) {
+    for (int i = 1; i < *argc; i++) {
+        if (strcmp(argv[i], option) == 0) {
+            for (int j = i; j < *argc - 1; j++) {
+                argv[j] = argv[j + 1];
+            }
+            (*argc)--;
+            argv[*argc] = NULL;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void print_usage(const char* program) {
+    fprintf(stderr,
+            "用法: %s [--profile] [--async] [模式]\n"
+            "不带模式时运行完整教程。模式:\n"
+            "  --parse-bench [MB]                 输入解析性能测试\n"
+            "  --codec-bench                      整数压缩编码性能测试\n"
+            "  --table-bench                      查找表性能测试\n"
+            "  --batch int|char|float [文件]      批量输入验证\n"
+            "  --trace-bench                      追踪开销测试\n"
+            "  --float-sweep [起始 结束]          float32位模式穷举测试\n"
+            "  --ring-bench                       异步输出环形缓冲区性能测试\n"
+            "全局选项:\n"
+            "  --profile  分段性能剖析（需要 -DENABLE_PROFILE 编译）\n"
+            "  --async    输出交给写线程（stdout是慢管道时计算不被阻塞）\n",
+            program);
+}
+
+int main(int argc, char* argv[]) {
+    // --profile: 打开分段性能剖析（需要 -DENABLE_PROFILE 编译），可与其他选项组合
+    if (take_option(&argc, argv, "--profile")) {
+#if defined(ENABLE_PROFILE) && defined(__GNUC__)
+        profile_start();
+#else
+        fprintf(stderr, "未定义ENABLE_PROFILE，忽略--profile\n");
+#endif
+    }
+    PROFILE_FUNCTION();
+    
+    // --async: 输出交给写线程，可与其他选项组合
+    bool async = take_option(&argc, argv, "--async");
+    
+    // --batch int|char|float [文件]: 批量输入验证（直接写fd 1，自带异步输出）
+    if (argc > 1 && strcmp(argv[1], "--batch") == 0) {
+        return batch_main(argc, argv, async);
+    }
+    
+    // 其余模式和教程都通过stdio输出，--async时把stdout接到环形缓冲区
+    if (async) {
+#ifdef HAVE_STDOUT_RING
+        if (stdout_ring_start()) {
+            atexit(stdout_ring_stop);   // 任何return路径都会写完剩余输出
+        } else {
+            fprintf(stderr, "无法启动写线程，改为同步输出\n");
+        }
+#else
+        fprintf(stderr, "本平台不支持异步输出，改为同步输出\n");
+#endif
+    }
+    
+    // --parse-bench [MB]: 只运行输入解析性能测试（默认64MB，可指定数GB）
+    if (argc > 1 && strcmp(argv[1], "--parse-bench") == 0) {
+        if (argc > 3) {
+            print_usage(argv[0]);
+            return 2;
+        }
+        uint64_t megabytes = (argc > 2) ? strtoull(argv[2], NULL, 10) : 64;
+        input_parser_benchmark(megabytes > 0 ? megabytes : 64);
+        return 0;
+    }
+    
+    // --codec-bench: 整数压缩编码的压缩率和解码速度测试
+    if (argc > 1 && strcmp(argv[1], "--codec-bench") == 0) {
+        if (argc > 2) {
+            print_usage(argv[0]);
+            return 2;
+        }
+        integer_codec_benchmark();
+        return 0;
+    }
+    
+    // --table-bench: 查找表与逐位/ctype实现的对比测试
+    if (argc > 1 && strcmp(argv[1], "--table-bench") == 0) {
+        if (argc > 2) {
+            print_usage(argv[0]);
+            return 2;
+        }
+        lookup_table_benchmark();
+        return 0;
+    }
+    
+    // --trace-bench: 追踪开销测试（需要 -DENABLE_TRACE 编译）
+    if (argc > 1 && strcmp(argv[1], "--trace-bench") == 0) {
+        if (argc > 2) {
+            print_usage(argv[0]);
+            return 2;
+        }
+        trace_benchmark();
+        return 0;
+    }
+    
+    // --float-sweep [起始 结束]: float32位模式穷举测试（默认全部2^32个）
+    if (argc > 1 && strcmp(argv[1], "--float-sweep") == 0) {
+        uint32_t first = 0;
+        uint32_t last = UINT32_MAX;
+        if (argc != 2 && (argc != 4 || !parse_float_bits(argv[2], &first) ||
+                          !parse_float_bits(argv[3], &last))) {
+            fprintf(stderr, "用法: %s --float-sweep [起始位模式 结束位模式]\n"
+                    "位模式为0~0xffffffff的整数，例如 0x3f800000 0x3fffffff\n",
+                    argv[0]);
+            return 2;
+        }
+        if (first > last) {
+            fprintf(stderr, "起始位模式不能大于结束位模式\n");
+            return 2;
+        }
+        float_precision_sweep(first, last);
+        return 0;
+    }
+    
+    // --ring-bench: 异步输出环形缓冲区性能测试
+    if (argc > 1 && strcmp(argv[1], "--ring-bench") == 0) {
+        if (argc > 2) {
+            print_usage(argv[0]);
+            return 2;
+        }
+#ifdef HAVE_PTHREAD
+        async_output_benchmark();
+        return 0;
+#else
+        printf("本平台不支持线程，无法运行该测试\n");
+        return 1;
+#endif
+    }
+    
+    if (argc > 1) {
+        fprintf(stderr, "未知参数: %s\n", argv[1]);
+        print_usage(argv[0]);
+        return 2;
+    }
+    
+    printf("C语言完整教程 - 基础数据类型详解\n");
+    printf("版本: v2.0.0\n");
+    printf("编译时间: %s %s\n", __DATE__, __TIME__);
+    
+    // 打印系统信息
+    print_type_info();
+    
+    // 演示各个主题
+    demonstrate_integer_types();
+    demonstrate_floating_types();
+    demonstrate_character_types();
+    demonstrate_boolean_types();
+    demonstrate_type_conversions();
+    demonstrate_io_formatting();
+    demonstrate_memory_model();
+    demonstrate_advanced_topics();
+    
+    // 内存转储示例
+    SECTION_HEADER("内存转储示例");
+    int sample_data[] = {0x12345678, 0xABCDEF00, 0x11223344};
+    hex_dump(sample_data, sizeof(sample_data));
+    
+    // 整数压缩编码
+    demonstrate_integer_compression();
     
     // 性能测试
     performance_tests();